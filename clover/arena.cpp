@@ -0,0 +1,87 @@
+#include "arena.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace{
+#ifdef _WIN32
+    // SẴy[W1񂸂ĎۂɊ蓖Ă
+    void touch(char *p, std::size_t size, std::size_t page){
+        for(std::size_t i = 0; i < size; i += page){
+            p[i] = 0;
+        }
+    }
+
+    char *map(std::size_t &size, unsigned options, bool &huge){
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        if(options & arena::huge_pages){
+            // SeLockMemoryPrivilege Βf. 傫y[W͍ŏ犄蓖čς
+            const std::size_t large = GetLargePageMinimum();
+            if(large > 0){
+                std::size_t rounded = (size + large - 1) / large * large;
+                void *p = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+                if(p){
+                    size = rounded;
+                    huge = true;
+                    return static_cast<char*>(p);
+                }
+            }
+        }
+        char *p = static_cast<char*>(VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if(p && (options & arena::prefault)){
+            touch(p, size, info.dwPageSize);
+        }
+        return p;
+    }
+
+    void unmap(char *p, std::size_t){
+        VirtualFree(p, 0, MEM_RELEASE);
+    }
+#else
+    char *map(std::size_t &size, unsigned options, bool &huge){
+        const int populate = (options & arena::prefault) ? MAP_POPULATE : 0;
+        if(options & arena::huge_pages){
+            // \񂳂ꂽ傫y[WΒf
+            const std::size_t large = 2 << 20;
+            std::size_t rounded = (size + large - 1) / large * large;
+            void *p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | populate, -1, 0);
+            if(p != MAP_FAILED){
+                size = rounded;
+                huge = true;
+                return static_cast<char*>(p);
+            }
+        }
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | populate, -1, 0);
+        if(p == MAP_FAILED){
+            return nullptr;
+        }
+        if(options & arena::huge_pages){
+            // ߓIȑ傫y[WɔC
+            madvise(p, size, MADV_HUGEPAGE);
+        }
+        return static_cast<char*>(p);
+    }
+
+    void unmap(char *p, std::size_t size){
+        munmap(p, size);
+    }
+#endif
+}
+
+arena::arena(std::size_t size, unsigned options) : block_size_(size){
+    region_ = map(size, options, huge_);
+    if(region_){
+        region_size_ = size;
+    }
+    // Ȃ new ̃ubNœ
+    reset();
+}
+
+arena::~arena(){
+    if(region_){
+        unmap(region_, region_size_);
+    }
+}
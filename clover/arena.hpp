@@ -0,0 +1,114 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+//-------- A[i
+// ̈̓珇ɐ؂õm
+// ʂɂ͉, reset A[i̔jł܂Ƃ߂ĕԂ
+// mۂAhX reset ܂œȂ
+//
+// ̈̎2ʂ
+//   arena(block_size)     : block_size oCg new őĂ
+//   arena(size, options)  : size oCg̘Äŏ OS 
+//                           reset ͐擪ɖ߂Ȃ̂ O(1)
+class arena{
+public:
+    // arena(size, options) ̗̈̎
+    enum option : unsigned{
+        // ƂɑSẴy[WɐGĂ, gƂɃy[WtH[gNȂ
+        prefault = 1 << 0,
+        // 傫y[Wg (gȂΕʂ̃y[W)
+        huge_pages = 1 << 1
+    };
+
+    explicit arena(std::size_t block_size = 1 << 20) : block_size_(block_size){}
+
+    // g؂ size oCg new ő (overflowed ŕ)
+    arena(std::size_t size, unsigned options);
+
+    ~arena();
+
+    arena(const arena&) = delete;
+    arena &operator =(const arena&) = delete;
+
+    // size oCg align ɑĊmۂ
+    void *allocate(std::size_t size, std::size_t align){
+        char *p = align_up(current_ + used_, align);
+        if(!current_ || p + size > current_ + current_size_){
+            // ubNɎ܂Ȃ傫͂ꂾ1ubNɂ
+            current_size_ = std::max(block_size_, size + align);
+            blocks_.emplace_back(new char[current_size_]);
+            block_total_ += current_size_;
+            current_ = blocks_.back().get();
+            p = align_up(current_, align);
+        }
+        used_ = static_cast<std::size_t>(p - current_) + size;
+        total_ += size;
+        return p;
+    }
+
+    // T  n  (͂Ȃ)
+    template<class T>
+    T *allocate(std::size_t n = 1){
+        return static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    // SĕԂ (mۂ̂͑SĖɂȂ. fXgN^͌Ă΂Ȃ)
+    void reset(){
+        blocks_.clear();
+        block_total_ = 0;
+        current_ = region_;
+        current_size_ = region_size_;
+        used_ = total_ = 0;
+    }
+
+    // reset Ămۂv (oCg)
+    std::size_t allocated() const{
+        return total_;
+    }
+
+    // Ă郁̍v (oCg). Ä new ̃ubN̎ۂ̑傫𑫂
+    std::size_t reserved() const{
+        return region_size_ + block_total_;
+    }
+
+    // ŏɎÄ̑傫 (oCg,  0)
+    std::size_t region_size() const{
+        return region_size_;
+    }
+
+    // Äg؂ new ̃ubN𑫂
+    bool overflowed() const{
+        return !blocks_.empty() && region_;
+    }
+
+    // 傫y[Wg
+    bool huge() const{
+        return huge_;
+    }
+
+private:
+    static char *align_up(char *p, std::size_t align){
+        std::uintptr_t a = reinterpret_cast<std::uintptr_t>(p);
+        return p + (((a + align - 1) & ~std::uintptr_t(align - 1)) - a);
+    }
+
+    std::size_t block_size_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    // blocks_ ̑傫̍v (block_size_ 傫ubN)
+    std::size_t block_total_ = 0;
+
+    // OS Ä
+    char *region_ = nullptr;
+    std::size_t region_size_ = 0;
+    bool huge_ = false;
+
+    // ؂oĂƂ
+    char *current_ = nullptr;
+    std::size_t current_size_ = 0, used_ = 0, total_ = 0;
+};
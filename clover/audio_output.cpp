@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <algorithm>
+#include "audio_output.hpp"
+
+namespace audio_output{
+    //-------- null_sink
+    // obt@Cꂽꍇ
+    static const int default_frames_per_buffer = 1024;
+
+    null_sink::null_sink(double rate) : rate_(rate), frames_(0), open_(false){}
+
+    null_sink::~null_sink(){
+        close();
+    }
+
+    bool null_sink::open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user){
+        channels_ = channels;
+        frames_per_buffer_ = frames_per_buffer == frames_unspecified ? default_frames_per_buffer : static_cast<int>(frames_per_buffer);
+        fn_ = fn;
+        user_ = user;
+        buffer_.resize(frames_per_buffer_ * channels_);
+        frames_ = 0;
+        open_ = true;
+        return true;
+    }
+
+    void null_sink::close(){
+        open_ = false;
+    }
+
+    bool null_sink::active() const{
+        return open_.load();
+    }
+
+    double null_sink::time() const{
+        return frames_.load() / rate_;
+    }
+
+    int null_sink::pump(int frames){
+        if(!open_){
+            return 0;
+        }
+        int done = 0;
+        while(done < frames){
+            int n = std::min(frames - done, frames_per_buffer_);
+            fn_(buffer_.data(), n, frames_.load() / rate_, 0, user_);
+            consume(buffer_.data(), n, channels_);
+            frames_ += n;
+            done += n;
+        }
+        return done;
+    }
+
+    //-------- wav_sink
+    wav_sink::wav_sink(const std::string &path, double rate) : null_sink(rate), path_(path){}
+
+    wav_sink::~wav_sink(){
+        close();
+    }
+
+    bool wav_sink::open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user){
+        close();
+        ofs_.open(path_, std::ios::binary | std::ios::trunc);
+        if(!ofs_){
+            return false;
+        }
+        data_bytes_ = 0;
+        if(!null_sink::open(channels, frames_per_buffer, fn, user)){
+            return false;
+        }
+        write_header();
+        return true;
+    }
+
+    void wav_sink::close(){
+        null_sink::close();
+        if(ofs_.is_open()){
+            // Ńwb_
+            ofs_.seekp(0);
+            write_header();
+            ofs_.close();
+        }
+    }
+
+    void wav_sink::consume(const sample_t *data, int frames, int channels){
+        std::streamsize bytes = static_cast<std::streamsize>(frames) * channels * sizeof(sample_t);
+        ofs_.write(reinterpret_cast<const char*>(data), bytes);
+        data_bytes_ += bytes;
+    }
+
+    void wav_sink::write_header(){
+        auto u32 = [this](std::uint32_t v){
+            const char b[4] = { static_cast<char>(v), static_cast<char>(v >> 8), static_cast<char>(v >> 16), static_cast<char>(v >> 24) };
+            ofs_.write(b, 4);
+        };
+        auto u16 = [this](std::uint16_t v){
+            const char b[2] = { static_cast<char>(v), static_cast<char>(v >> 8) };
+            ofs_.write(b, 2);
+        };
+        const std::uint32_t sample_rate = static_cast<std::uint32_t>(rate());
+        const std::uint16_t block_align = static_cast<std::uint16_t>(channels() * sizeof(sample_t));
+        ofs_.write("RIFF", 4);
+        u32(static_cast<std::uint32_t>(36 + data_bytes_));
+        ofs_.write("WAVE", 4);
+        ofs_.write("fmt ", 4);
+        u32(16);
+        u16(3); // WAVE_FORMAT_IEEE_FLOAT
+        u16(static_cast<std::uint16_t>(channels()));
+        u32(sample_rate);
+        u32(sample_rate * block_align);
+        u16(block_align);
+        u16(32);
+        ofs_.write("data", 4);
+        u32(static_cast<std::uint32_t>(data_bytes_));
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <fstream>
+
+//-------- o͐
+// ~LT[̕`݊֐Ăŉo
+// ۂ̃foCX (portaudio_output.hpp) ̑, foCXŎԂ葬񂹂o͐
+namespace audio_output{
+    using sample_t = float;
+
+    // obt@o͐ɔC
+    const unsigned long frames_unspecified = 0;
+
+    // process_fn ɓno͂̏
+    // Õobt@Ԃɍ킸r؂ꂽ
+    const unsigned status_underflow = 1;
+    // ̈ꕔ̂Ăꂽ
+    const unsigned status_overflow = 2;
+
+    // out (C^[[u)  frames t[
+    // dac_time  out ̐擪̃t[鎞 (backend::time Ɠv)
+    // status  status_underflow Ȃǂ̑gݍ킹
+    using process_fn = void (*)(sample_t *out, int frames, double dac_time, unsigned status, void *user);
+
+    class backend{
+    public:
+        virtual ~backend() = default;
+
+        // J fn Ăюn߂
+        virtual bool open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user) = 0;
+        virtual void close() = 0;
+
+        // fn Ă΂ꑱĂ
+        virtual bool active() const = 0;
+
+        // Tv[g
+        virtual double rate() const = 0;
+
+        // P鎞v (b)
+        virtual double time() const = 0;
+
+        // Ă畷܂ł̒x (b)
+        virtual double latency() const = 0;
+
+        // R[obNCPUԂgĂ銄 (0  1). Ȃ 0
+        virtual double cpu_load() const{
+            return 0.0;
+        }
+    };
+
+    // ǂɂoȂo͐
+    // ł̓Xbh, pump Ă񂾕̏ŕ`܂
+    // v͕`񂾃t[̂, Ăԑ̑ (CPU葬) i
+    class null_sink : public backend{
+    public:
+        explicit null_sink(double rate = 44100.0);
+        ~null_sink();
+
+        bool open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user) override;
+        void close() override;
+        bool active() const override;
+
+        double rate() const override{
+            return rate_;
+        }
+
+        double time() const override;
+
+        double latency() const override{
+            return 0.0;
+        }
+
+        // frames t[`܂. JĂȂ 0
+        int pump(int frames);
+
+        // 1obt@
+        int pump(){
+            return pump(frames_per_buffer_);
+        }
+
+        // ܂łɕ`܂t[
+        long long frames() const{
+            return frames_.load();
+        }
+
+        int channels() const{
+            return channels_;
+        }
+
+    protected:
+        // `܂ꂽ (data[frames * channels]) 󂯎. ł͎̂Ă
+        virtual void consume(const sample_t *, int, int){}
+
+    private:
+        double rate_;
+        int channels_ = 0;
+        int frames_per_buffer_ = 0;
+        process_fn fn_ = nullptr;
+        void *user_ = nullptr;
+        std::vector<sample_t> buffer_;
+        std::atomic<long long> frames_;
+        std::atomic<bool> open_;
+    };
+
+    // `܂ꂽ 32bit float  WAVE t@Cɏo͐
+    class wav_sink : public null_sink{
+    public:
+        wav_sink(const std::string &path, double rate = 44100.0);
+        ~wav_sink();
+
+        bool open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user) override;
+        void close() override;
+
+    protected:
+        void consume(const sample_t *data, int frames, int channels) override;
+
+    private:
+        void write_header();
+
+        std::string path_;
+        std::ofstream ofs_;
+        long long data_bytes_ = 0;
+    };
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include "audio_session.hpp"
+#include "thread_config.hpp"
+
+namespace audio_session{
+    session::session(mixer::engine &audio, playlist::engine &music, mixer::render_fn render) :
+        audio_(audio), music_(music), render_(render), failed_(false)
+    {}
+
+    session::~session(){
+        shutdown();
+    }
+
+    void session::play(std::vector<std::string> paths, resampler::quality q){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(request_ == request::quit){
+                return;
+            }
+            request_ = request::play;
+            paths_ = std::move(paths);
+            quality_ = q;
+            failed_ = false;
+            // Xbh͍ŏ̗vŗĂ
+            if(!thread_.joinable()){
+                thread_ = std::thread([this](){ thread_main(); });
+            }
+        }
+        cond_.notify_one();
+    }
+
+    void session::stop(){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(request_ == request::quit || !thread_.joinable()){
+                return;
+            }
+            request_ = request::stop;
+        }
+        cond_.notify_one();
+    }
+
+    bool session::take_failure(){
+        return failed_.exchange(false);
+    }
+
+    void session::shutdown(){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            request_ = request::quit;
+        }
+        cond_.notify_one();
+        if(thread_.joinable()){
+            thread_.join();
+        }
+    }
+
+    bool session::interrupted(){
+        std::lock_guard<std::mutex> lock(mutex_);
+        return request_ != request::none;
+    }
+
+    void session::release(){
+        // R[obNOĂȂj
+        if(attached_){
+            audio_.set_music(nullptr, nullptr);
+            attached_ = false;
+        }
+        if(started_){
+            music_.stop();
+            started_ = false;
+        }
+    }
+
+    void session::thread_main(){
+        thread_config::apply(thread_config::role::worker);
+        std::unique_lock<std::mutex> lock(mutex_);
+        for(;;){
+            cond_.wait(lock, [this](){ return request_ != request::none; });
+            request r = request_;
+            std::vector<std::string> paths = std::move(paths_);
+            resampler::quality q = quality_;
+            if(r != request::quit){
+                request_ = request::none;
+            }
+            lock.unlock();
+
+            release();
+            if(r == request::quit){
+                return;
+            }
+
+            if(r == request::play){
+                // Ȃ̓ǂݍ݂̓vCXg̃[J[s
+                // o҂Ԃ̗v炷ɐ؂ւ
+                music_.start(paths, audio_.rate(), q, mixer::channels);
+                started_ = true;
+                for(;;){
+                    playlist::engine::ready_state state = music_.wait_ready_for(std::chrono::milliseconds(ready_poll_ms));
+                    if(state == playlist::engine::ready_state::ready){
+                        audio_.set_music(render_, &music_);
+                        attached_ = true;
+                        break;
+                    }
+                    if(state == playlist::engine::ready_state::failed){
+                        release();
+                        // ̗vĂ玸s͓`Ȃ
+                        std::lock_guard<std::mutex> guard(mutex_);
+                        if(request_ == request::none){
+                            failed_ = true;
+                        }
+                        break;
+                    }
+                    if(interrupted()){
+                        break;
+                    }
+                }
+            }
+            lock.lock();
+        }
+    }
+}
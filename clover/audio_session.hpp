@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#include "resampler.hpp"
+#include "playlist.hpp"
+#include "mixer.hpp"
+
+//-------- y̍ĐZbV
+// Ȃ̊Jn/؂ւ/~p̃Xbhōs
+// v͏ϐőɓ͂̂, UIXbh͐ςނő҂Ȃ
+// ؂ւ̓vCXg~߂Ăn߂̂, [J[JĂr̋Ȃ
+// ΂ open I܂Œx (foCX̃obt@1ł͎܂Ȃ)
+namespace audio_session{
+    class session{
+    public:
+        // render  music ɂă~LT[Ă΂鉹ỹR[obN
+        session(mixer::engine &audio, playlist::engine &music, mixer::render_fn render);
+        ~session();
+
+        //-------- ȉUIXbhĂ (ubNȂ)
+        // Đ̋Ȃ~߂ paths ɍĐ
+        void play(std::vector<std::string> paths, resampler::quality q);
+
+        // Đ~߂
+        void stop();
+
+        // ߂ play 1ȂJȂ (ǂނ false ɖ߂)
+        bool take_failure();
+
+        // Ȃ~߂ăXbhI点
+        // ~LT[OɌĂԂ
+        void shutdown();
+
+    private:
+        enum class request{
+            none,
+            play,
+            stop,
+            quit
+        };
+
+        void thread_main();
+
+        // VvĂ
+        bool interrupted();
+
+        // ~LT[OċȂj
+        void release();
+
+        // o҂Ԋu
+        static const int ready_poll_ms = 2;
+
+        mixer::engine &audio_;
+        playlist::engine &music_;
+        mixer::render_fn render_;
+
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        request request_ = request::none;
+        std::vector<std::string> paths_;
+        resampler::quality quality_ = resampler::quality::medium;
+        std::atomic<bool> failed_;
+
+        // ȉ̓ZbṼXbhG
+        bool started_ = false;
+        bool attached_ = false;
+    };
+}
@@ -60,6 +60,19 @@ class AudioDecoder : public AudioDecoderCoreAudio
     public:
         AudioDecoder(const std::string filename) : AudioDecoderCoreAudio(filename) {};
 };
+
+#else
+#include "audiodecoderwave.h"
+
+/** Other platforms (e.g. headless Linux runs) only get the portable
+ *  WAVE decoder. */
+class AudioDecoder : public AudioDecoderWave
+{
+    public:
+        AudioDecoder(const std::string filename) : AudioDecoderWave(filename) {};
+        AudioDecoder(const AudioDecoder&) = delete;
+        AudioDecoder &operator =(const AudioDecoder&) = delete;
+};
 #endif
 
 #endif //__AUDIODECODER_H__
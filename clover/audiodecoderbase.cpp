@@ -54,3 +54,56 @@ AudioDecoderBase::~AudioDecoderBase()
 }
 
 
+/**
+ * Default implementation on top of read(): decoders only have to provide
+ * read(), which may return less than asked for as long as it returns
+ * something until the end of the stream.
+ */
+size_t AudioDecoderBase::readFrames(SAMPLE *dest, size_t frames)
+{
+    if (m_iChannels <= 0) {
+        return 0;
+    }
+    const size_t chunkFrames = kBlockSamples / m_iChannels;
+    size_t done = 0;
+    while (done < frames) {
+        size_t want = frames - done < chunkFrames ? frames - done : chunkFrames;
+        int got = read(static_cast<int>(want * m_iChannels), dest + done * m_iChannels);
+        if (got <= 0) {
+            break;
+        }
+        done += got / m_iChannels;
+    }
+    return done;
+}
+
+size_t AudioDecoderBase::readFramesPlanar(SAMPLE * const *dest, size_t frames)
+{
+    size_t done = 0;
+    while (done < frames) {
+        const SAMPLE *block(NULL);
+        size_t got = borrowBlock(&block, frames - done);
+        if (got == 0) {
+            break;
+        }
+        for (int ch = 0; ch < m_iChannels; ++ch) {
+            SAMPLE *out = dest[ch] + done;
+            const SAMPLE *in = block + ch;
+            for (size_t i = 0; i < got; ++i) {
+                out[i] = in[i * m_iChannels];
+            }
+        }
+        done += got;
+    }
+    return done;
+}
+
+size_t AudioDecoderBase::borrowBlock(const SAMPLE **block, size_t maxFrames)
+{
+    *block = m_blockBuffer;
+    if (m_iChannels <= 0) {
+        return 0;
+    }
+    const size_t chunkFrames = kBlockSamples / m_iChannels;
+    return readFrames(m_blockBuffer, maxFrames < chunkFrames ? maxFrames : chunkFrames);
+}
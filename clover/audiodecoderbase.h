@@ -70,20 +70,39 @@ class DllExport AudioDecoderBase
         virtual ~AudioDecoderBase();
 
         /** Opens the file for decoding */
-        int open() { return 0; };
+        virtual int open() { return 0; };
 
         /** Seek to a sample in the file */
-        int seek(int filepos) { return 0l; };
+        virtual int seek(int) { return 0l; };
 
         /** Read a maximum of 'size' samples of audio into buffer. 
             Samples are always returned as 32-bit floats, with stereo interlacing.
-            Returns the number of samples read. */
-        int read(int size, const SAMPLE *buffer) { return 0u; };
+            Returns the number of samples read. Decoders may limit how many
+            samples one call returns; use readFrames() for arbitrary counts. */
+        virtual int read(int, SAMPLE *) { return 0; };
+
+        /** Read up to 'frames' interleaved frames (frames * channels() floats)
+            into 'dest'. Returns the number of frames read, fewer than requested
+            only at the end of the stream. Never allocates. */
+        virtual size_t readFrames(SAMPLE *dest, size_t frames);
+
+        /** Same as readFrames() but deinterleaves: dest[ch] receives up to
+            'frames' samples of channel ch. 'dest' must hold channels() pointers. */
+        virtual size_t readFramesPlanar(SAMPLE * const *dest, size_t frames);
+
+        /** Zero-copy read: points '*block' at up to 'maxFrames' interleaved
+            frames of decoded audio owned by the decoder and returns how many
+            there are (0 at the end of the stream). The block is only valid
+            until the next call to any read or seek function. Decoders that
+            already hold their output in memory hand it out directly, the
+            others decode into an internal block buffer, which caps the frame
+            count at kBlockSamples / channels(). */
+        virtual size_t borrowBlock(const SAMPLE **block, size_t maxFrames);
 
         /** Get the number of audio samples in the file. This will be a good estimate of the 
             number of samples you can get out of read(), though you should not rely on it
             being perfectly accurate always. (eg. it might be slightly inaccurate with VBR MP3s)*/
-        inline int    numSamples()        const { return m_iNumSamples; };
+        virtual int   numSamples()        const { return m_iNumSamples; };
 
         /** Get the number of channels in the audio file */
         inline int    channels()          const { return m_iChannels; };
@@ -103,6 +122,10 @@ class DllExport AudioDecoderBase
             return std::vector<std::string>();
         };
 
+        /** Size of the internal block buffer used by the default
+            readFrames()/readFramesPlanar()/borrowBlock(), in samples */
+        static const int kBlockSamples = 4096;
+
     protected:
         std::string     m_filename;
         int   m_iNumSamples;
@@ -110,6 +133,7 @@ class DllExport AudioDecoderBase
         int   m_iSampleRate;
         float m_fDuration; // in seconds
         int   m_iPositionInSamples; // in samples;
+        SAMPLE m_blockBuffer[kBlockSamples];
 };
 
 #endif //__AUDIODECODERBASE_H__
@@ -21,7 +21,11 @@
  ***************************************************************************/
 
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <windows.h>
 #include <mfapi.h>
 #include <mfidl.h>
@@ -31,6 +35,7 @@
 #include <assert.h>
 
 #include "audiodecodermediafoundation.h"
+#include "audiodecoderpcmcache.h"
 
 const int kBitsPerSample = 16;
 const int kNumChannels = 2;
@@ -40,6 +45,18 @@ const int kLeftoverSize = 4096; // in int16's, this seems to be the size MF AAC
 
 const static bool sDebug = false;
 
+// Seek index file written next to the track ("<track>.seekidx")
+const char kSeekIndexSuffix[] = ".seekidx";
+const char kSeekIndexMagic[4] = { 'C', 'S', 'I', 'X' };
+const unsigned int kSeekIndexVersion = 1;
+// Smallest buffer MF hands out for the compressed formats we open (an MPEG-2
+// layer III frame). The index is reserved for this many frames per point so
+// read() never grows it.
+const __int64 kSeekIndexMinBufferFrames = 576;
+// Number of MF buffers decoded (and discarded) ahead of the seek target so
+// that decoders with inter-frame state (MP3 bit reservoir) are primed.
+const int kSeekPrerollBuffers = 1;
+
 /** Microsoft examples use this snippet often. */
 template<class T> static void safeRelease(T **ppT)
 {
@@ -76,6 +93,13 @@ AudioDecoderMediaFoundation::AudioDecoderMediaFoundation(const std::string filen
     , m_iCurrentPosition(0)
     , m_dead(false)
     , m_seeking(false)
+    , m_endOfStream(false)
+    , m_pcmCache(NULL)
+    , m_cacheHit(false)
+    , m_seekIndexNextFrame(-1)
+    , m_seekIndexComplete(false)
+    , m_seekIndexDirty(false)
+    , m_cacheUntouched(false)
 {
     //Defaults
     m_iChannels = kNumChannels;
@@ -89,13 +113,22 @@ AudioDecoderMediaFoundation::AudioDecoderMediaFoundation(const std::string filen
 
 AudioDecoderMediaFoundation::~AudioDecoderMediaFoundation()
 {
+    // read() only marks a finished index; the file is written here, off the
+    // audio callback
+    if (m_seekIndexDirty) {
+        saveSeekIndex();
+    }
     delete [] m_wcFilename;
     delete [] m_leftoverBuffer;
+    delete m_pcmCache;
 
     safeRelease(&m_pReader);
     safeRelease(&m_pAudioType);
-    MFShutdown();
-    CoUninitialize();
+    // a cache hit never started COM/MF
+    if (!m_cacheHit) {
+        MFShutdown();
+        CoUninitialize();
+    }
 }
 
 int AudioDecoderMediaFoundation::open()
@@ -104,6 +137,19 @@ int AudioDecoderMediaFoundation::open()
         std::cout << "open() " << m_filename << std::endl;
     }
 
+    // A previously decoded copy of this track makes MF unnecessary: read()
+    // and seek() work straight on the mapped PCM.
+    m_pcmCache = new PcmCache(m_filename);
+    if (m_pcmCache->map()) {
+        m_cacheHit = true;
+        m_iChannels = m_pcmCache->channels();
+        m_iSampleRate = m_pcmCache->sampleRate();
+        m_mfDuration = mfFromFrame(m_pcmCache->numFrames());
+        m_fDuration = secondsFromMF(m_mfDuration);
+        m_iCurrentPosition = 0;
+        return AUDIODECODER_OK;
+    }
+
     //Assumes m_filename is ASCII and converts it to UTF-16 (wide char).
     /*
 	int wcFilenameLength = m_filename.size();
@@ -162,21 +208,57 @@ int AudioDecoderMediaFoundation::open()
         return AUDIODECODER_ERROR;
     }
 
+    //A seek index from an earlier full decode lets seek() jump straight to
+    //the right MF buffer. If there isn't one, read() builds it as we go.
+    if (!loadSeekIndex()) {
+        m_seekIndex.clear();
+        // read() may run on the audio callback, so make room for the whole
+        // index now (recordSeekPoint gives up rather than reallocate)
+        __int64 frames(frameFromMF(m_mfDuration));
+        m_seekIndex.reserve(static_cast<size_t>(frames / kSeekIndexMinBufferFrames + 16));
+    }
+
     //Seek to position 0, which forces us to skip over all the header frames.
     //This makes sure we're ready to just let the Analyser rip and it'll
     //get the number of samples it expects (ie. no header frames).
     seek(0);
 
+    // Start the cache writer here rather than in seek(), which may be called
+    // on the audio callback and must not join or spawn threads.
+    m_cacheUntouched = m_pcmCache->beginWrite(m_iChannels, m_iSampleRate);
+
     return AUDIODECODER_OK;
 }
 
 int AudioDecoderMediaFoundation::seek(int sampleIdx)
 {
     if (sDebug) { std::cout << "seek() " << sampleIdx << std::endl; }
+    if (m_cacheHit) {
+        __int64 numSamples(m_pcmCache->numFrames() * m_iChannels);
+        m_iCurrentPosition = sampleIdx < 0 ? 0
+            : sampleIdx > numSamples ? static_cast<long>(numSamples)
+            : sampleIdx - sampleIdx % m_iChannels;
+        return m_iCurrentPosition;
+    }
     PROPVARIANT prop;
     HRESULT hr(S_OK);
     __int64 seekTarget(sampleIdx / m_iChannels);
     __int64 mfSeekTarget(mfFromFrame(seekTarget) - 1);
+    if (m_seekIndexComplete && !m_seekIndex.empty()) {
+        // Land exactly on the timestamp of the buffer holding seekTarget (less
+        // the preroll), so read() only has to skip inside that buffer.
+        SeekPoint key = { seekTarget, 0 };
+        std::vector<SeekPoint>::const_iterator it = std::upper_bound(
+            m_seekIndex.begin(), m_seekIndex.end(), key,
+            [](const SeekPoint &a, const SeekPoint &b) { return a.frame < b.frame; });
+        size_t i = it == m_seekIndex.begin() ? 0 : (it - m_seekIndex.begin()) - 1;
+        i = i > static_cast<size_t>(kSeekPrerollBuffers) ? i - kSeekPrerollBuffers : 0;
+        mfSeekTarget = m_seekIndex[i].mfTimestamp;
+    } else {
+        // Only a decode that starts at frame 0 can build the index.
+        m_seekIndex.clear();
+        m_seekIndexNextFrame = seekTarget == 0 ? 0 : -1;
+    }
     // minus 1 here seems to make our seeking work properly, otherwise we will
     // (more often than not, maybe always) seek a bit too far (although not
     // enough for our calculatedFrameFromMF <= nextFrame assertion in ::read).
@@ -212,12 +294,30 @@ int AudioDecoderMediaFoundation::seek(int sampleIdx)
     // time we get a buffer from MFSourceReader
     m_nextFrame = seekTarget;
     m_seeking = true;
+    m_endOfStream = false;
     m_iCurrentPosition = result;
+
+    // Only a decode that runs from the very start to the end can be cached,
+    // so any seek after samples went to the cache drops the entry. The writer
+    // is never restarted from here.
+    if (seekTarget != 0 || !m_cacheUntouched) {
+        m_pcmCache->abandonWrite();
+    }
     return result;
 }
 
-int AudioDecoderMediaFoundation::read(int size, const SAMPLE *destination)
+int AudioDecoderMediaFoundation::read(int size, SAMPLE *destination)
 {
+    if (m_cacheHit) {
+        __int64 available(m_pcmCache->numFrames() * m_iChannels - m_iCurrentPosition);
+        long samples_read = size < available ? size : static_cast<long>(available);
+        memcpy(destination,
+            m_pcmCache->samples() + m_iCurrentPosition,
+            samples_read * sizeof(SAMPLE));
+        m_iCurrentPosition += samples_read;
+        return samples_read;
+    }
+
 	assert(size < sizeof(m_destBufferShort));
     if (sDebug) { std::cout << "read() " << size << std::endl; }
 	//TODO: Change this up if we want to support just short samples again -- Albert
@@ -276,6 +376,16 @@ int AudioDecoderMediaFoundation::read(int size, const SAMPLE *destination)
             break;
         } else if (dwFlags & MF_SOURCE_READERF_ENDOFSTREAM) {
             std::cout << "SSMF: End of input file." << std::endl;
+            m_endOfStream = true;
+            // We've decoded every buffer from frame 0 without a gap, so the
+            // index is complete; keep it for the next time this file is opened.
+            // Writing it is left to the destructor, read() may be running on
+            // the audio callback.
+            if (!m_seekIndexComplete && m_seekIndexNextFrame >= 0
+                && !m_seekIndex.empty()) {
+                m_seekIndexComplete = true;
+                m_seekIndexDirty = true;
+            }
             break;
         } else if (dwFlags & MF_SOURCE_READERF_CURRENTMEDIATYPECHANGED) {
             std::cerr << "SSMF: Type change";
@@ -305,8 +415,12 @@ int AudioDecoderMediaFoundation::read(int size, const SAMPLE *destination)
         }
         bufferLength /= (m_iBitsPerSample / 8 * m_iChannels); // now in frames
 
+        if (!m_seekIndexComplete) {
+            recordSeekPoint(timestamp, bufferLength);
+        }
+
         if (m_seeking) {
-            __int64 bufferPosition(frameFromMF(timestamp));
+            __int64 bufferPosition(frameFromTimestamp(timestamp));
             if (sDebug) {
                 std::cout << "While seeking to "
                          << m_nextFrame << "WMF put us at " << bufferPosition
@@ -406,7 +520,7 @@ releaseSample:
 	//Convert to float samples
 	if (m_iChannels == 2)
 	{
-		SAMPLE *destBufferFloat(const_cast<SAMPLE*>(destination));
+		SAMPLE *destBufferFloat(destination);
 		for (unsigned long i = 0; i < samples_read; i++)
 		{
 			destBufferFloat[i] = destBuffer[i] / (float)sampleMax;
@@ -414,17 +528,50 @@ releaseSample:
 	}
 	else //Assuming mono, duplicate into stereo frames...
 	{
-		SAMPLE *destBufferFloat(const_cast<SAMPLE*>(destination));
+		SAMPLE *destBufferFloat(destination);
 		for (unsigned long i = 0; i < samples_read; i++)
 		{
 			destBufferFloat[i] = destBuffer[i] / (float)sampleMax;
 		}
 	}
+
+    if (m_pcmCache->writing()) {
+        if (m_dead) {
+            m_pcmCache->abandonWrite();
+        } else {
+            m_pcmCache->append(destination, samples_read);
+            m_cacheUntouched = false;
+            if (m_endOfStream) {
+                m_pcmCache->finishWrite();
+            }
+        }
+    }
     return samples_read;
 }
 
-inline int AudioDecoderMediaFoundation::numSamples()
+/**
+ * On a cache hit the decoded PCM is already in memory, so hand out a pointer
+ * into the mapping instead of copying it.
+ */
+size_t AudioDecoderMediaFoundation::borrowBlock(const SAMPLE **block,
+    size_t maxFrames)
+{
+    if (!m_cacheHit) {
+        return AudioDecoderBase::borrowBlock(block, maxFrames);
+    }
+    __int64 available((m_pcmCache->numFrames() * m_iChannels - m_iCurrentPosition) / m_iChannels);
+    size_t frames = static_cast<__int64>(maxFrames) < available
+        ? maxFrames : static_cast<size_t>(available);
+    *block = m_pcmCache->samples() + m_iCurrentPosition;
+    m_iCurrentPosition += static_cast<long>(frames * m_iChannels);
+    return frames;
+}
+
+int AudioDecoderMediaFoundation::numSamples() const
 {
+    if (m_cacheHit) {
+        return static_cast<int>(m_pcmCache->numFrames() * m_iChannels);
+    }
     int len(secondsFromMF(m_mfDuration) * m_iSampleRate * m_iChannels);
     return len % m_iChannels == 0 ? len : len + 1;
 }
@@ -702,7 +849,7 @@ void AudioDecoderMediaFoundation::copyFrames(
 /**
  * Convert a 100ns Media Foundation value to a number of seconds.
  */
-inline double AudioDecoderMediaFoundation::secondsFromMF(__int64 mf)
+inline double AudioDecoderMediaFoundation::secondsFromMF(__int64 mf) const
 {
     return static_cast<double>(mf) / 1e7;
 }
@@ -730,3 +877,131 @@ inline __int64 AudioDecoderMediaFoundation::mfFromFrame(__int64 frame)
 {
     return static_cast<double>(frame) / m_iSampleRate * 1e7;
 }
+
+/**
+ * Path of the seek index that belongs to m_filename.
+ */
+std::string AudioDecoderMediaFoundation::seekIndexPath() const
+{
+    return m_filename + kSeekIndexSuffix;
+}
+
+/**
+ * Loads the seek index written by an earlier full decode of this file. The
+ * index is only trusted if the track's size and modification time still
+ * match and it was built at the same sample rate.
+ */
+bool AudioDecoderMediaFoundation::loadSeekIndex()
+{
+    struct _stat64 st;
+    if (_stat64(m_filename.c_str(), &st) != 0) {
+        return false;
+    }
+    std::ifstream f(seekIndexPath().c_str(), std::ios::binary);
+    if (!f) {
+        return false;
+    }
+    char magic[4];
+    unsigned int version(0), sampleRate(0);
+    __int64 fileSize(0), fileTime(0), count(0);
+    f.read(magic, sizeof(magic));
+    f.read(reinterpret_cast<char*>(&version), sizeof(version));
+    f.read(reinterpret_cast<char*>(&sampleRate), sizeof(sampleRate));
+    f.read(reinterpret_cast<char*>(&fileSize), sizeof(fileSize));
+    f.read(reinterpret_cast<char*>(&fileTime), sizeof(fileTime));
+    f.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!f || memcmp(magic, kSeekIndexMagic, sizeof(magic)) != 0
+        || version != kSeekIndexVersion
+        || sampleRate != static_cast<unsigned int>(m_iSampleRate)
+        || fileSize != st.st_size || fileTime != st.st_mtime
+        || count <= 0) {
+        return false;
+    }
+    m_seekIndex.resize(static_cast<size_t>(count));
+    f.read(reinterpret_cast<char*>(&m_seekIndex[0]),
+        sizeof(SeekPoint) * m_seekIndex.size());
+    if (!f) {
+        return false;
+    }
+    m_seekIndexComplete = true;
+    if (sDebug) {
+        std::cout << "SSMF: loaded seek index with " << count << " points" << std::endl;
+    }
+    return true;
+}
+
+/**
+ * Writes the seek index next to the track. Failing to write it (read-only
+ * media, etc.) is harmless, we'll just build it again next time.
+ */
+bool AudioDecoderMediaFoundation::saveSeekIndex() const
+{
+    struct _stat64 st;
+    if (_stat64(m_filename.c_str(), &st) != 0) {
+        return false;
+    }
+    std::ofstream f(seekIndexPath().c_str(), std::ios::binary | std::ios::trunc);
+    if (!f) {
+        return false;
+    }
+    unsigned int version(kSeekIndexVersion);
+    unsigned int sampleRate(m_iSampleRate);
+    __int64 fileSize(st.st_size), fileTime(st.st_mtime);
+    __int64 count(m_seekIndex.size());
+    f.write(kSeekIndexMagic, sizeof(kSeekIndexMagic));
+    f.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    f.write(reinterpret_cast<const char*>(&sampleRate), sizeof(sampleRate));
+    f.write(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+    f.write(reinterpret_cast<const char*>(&fileTime), sizeof(fileTime));
+    f.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    f.write(reinterpret_cast<const char*>(&m_seekIndex[0]),
+        sizeof(SeekPoint) * m_seekIndex.size());
+    return static_cast<bool>(f);
+}
+
+/**
+ * Called for every buffer MF hands us while the index is incomplete. Points
+ * are only recorded while decoding runs contiguously from frame 0; seeking
+ * anywhere else abandons the partial index until the next decode from the
+ * start. The first buffer is placed where MF says it is, like read() does,
+ * and every later one directly after its predecessor. The index was reserved
+ * in open(); if the track has more buffers than estimated, the index is
+ * abandoned instead of reallocating on the audio callback.
+ */
+void AudioDecoderMediaFoundation::recordSeekPoint(__int64 mfTimestamp,
+    size_t frames)
+{
+    if (m_seekIndexNextFrame < 0) {
+        return;
+    }
+    if (m_seekIndex.size() == m_seekIndex.capacity()) {
+        m_seekIndex.clear();
+        m_seekIndexNextFrame = -1;
+        return;
+    }
+    SeekPoint point = {
+        m_seekIndex.empty() ? frameFromMF(mfTimestamp) : m_seekIndexNextFrame,
+        mfTimestamp
+    };
+    m_seekIndex.push_back(point);
+    m_seekIndexNextFrame = point.frame + frames;
+}
+
+/**
+ * Frame offset of the MF buffer stamped mfTimestamp. Buffers we've indexed
+ * give the exact frame; anything else falls back to converting the
+ * timestamp, which can be off by a few frames.
+ */
+__int64 AudioDecoderMediaFoundation::frameFromTimestamp(__int64 mfTimestamp)
+{
+    if (m_seekIndexComplete) {
+        SeekPoint key = { 0, mfTimestamp };
+        std::vector<SeekPoint>::const_iterator it = std::lower_bound(
+            m_seekIndex.begin(), m_seekIndex.end(), key,
+            [](const SeekPoint &a, const SeekPoint &b) { return a.mfTimestamp < b.mfTimestamp; });
+        if (it != m_seekIndex.end() && it->mfTimestamp == mfTimestamp) {
+            return it->frame;
+        }
+    }
+    return frameFromMF(mfTimestamp);
+}
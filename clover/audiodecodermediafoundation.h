@@ -21,6 +21,7 @@
 struct IMFSourceReader;
 struct IMFMediaType;
 struct IMFMediaSource;
+class PcmCache;
 
 #define SHORT_SAMPLE short
 
@@ -31,19 +32,30 @@ class DllExport AudioDecoderMediaFoundation : public AudioDecoderBase {
     ~AudioDecoderMediaFoundation();
     int open();
     int seek(int sampleIdx);
-    int read(int size, const SAMPLE *buffer);
-    inline int numSamples();
-    std::vector<std::string> supportedFileExtensions();
+    int read(int size, SAMPLE *buffer);
+    size_t borrowBlock(const SAMPLE **block, size_t maxFrames);
+    int numSamples() const;
+    static std::vector<std::string> supportedFileExtensions();
 
   private:
     bool configureAudioStream();
     bool readProperties();
     void copyFrames(short *dest, size_t *destFrames, const short *src,
         size_t srcFrames);
-    inline double secondsFromMF(__int64 mf);
+    inline double secondsFromMF(__int64 mf) const;
     inline __int64 mfFromSeconds(double sec);
     inline __int64 frameFromMF(__int64 mf);
     inline __int64 mfFromFrame(__int64 frame);
+    /** One decoded MF buffer: its exact first frame and its MF timestamp */
+    struct SeekPoint {
+        __int64 frame;
+        __int64 mfTimestamp;
+    };
+    std::string seekIndexPath() const;
+    bool loadSeekIndex();
+    bool saveSeekIndex() const;
+    void recordSeekPoint(__int64 mfTimestamp, size_t frames);
+    __int64 frameFromTimestamp(__int64 mfTimestamp);
     IMFSourceReader *m_pReader;
     IMFMediaType *m_pAudioType;
     wchar_t *m_wcFilename;
@@ -56,7 +68,15 @@ class DllExport AudioDecoderMediaFoundation : public AudioDecoderBase {
     long m_iCurrentPosition;
     bool m_dead;
     bool m_seeking;
+    bool m_endOfStream;
+    PcmCache *m_pcmCache;
+    bool m_cacheHit;
 	unsigned int m_iBitsPerSample;
+    std::vector<SeekPoint> m_seekIndex;
+    __int64 m_seekIndexNextFrame;
+    bool m_seekIndexComplete;
+    bool m_seekIndexDirty;
+    bool m_cacheUntouched;
 	SHORT_SAMPLE m_destBufferShort[8192];
 };
 
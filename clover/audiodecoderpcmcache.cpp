@@ -0,0 +1,378 @@
+/**
+ * \file audiodecoderpcmcache.cpp
+ * \brief Memory-mapped decoded PCM cache, see audiodecoderpcmcache.h
+ */
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <windows.h>
+
+#include "audiodecoderpcmcache.h"
+
+const char kCacheMagic[4] = { 'C', 'P', 'C', 'M' };
+const unsigned int kCacheVersion = 1;
+const char kCacheSuffix[] = ".pcm";
+const char kCacheTempSuffix[] = ".tmp";
+// Samples the decoder can run ahead of the writer thread, about 3 seconds of
+// 44.1kHz stereo. Must be a power of two.
+const size_t kRingSamples = 1 << 18;
+const DWORD kWriterPollMs = 10;
+
+const static bool sDebug = false;
+
+std::string PcmCache::s_directory;
+__int64 PcmCache::s_maxBytes(0);
+
+/** On-disk header, followed directly by numFrames * channels floats. */
+struct PcmCache::Header {
+    char magic[4];
+    unsigned int version;
+    unsigned int channels;
+    unsigned int sampleRate;
+    __int64 numFrames;
+    __int64 trackSize;
+    __int64 trackTime;
+};
+
+void PcmCache::configure(const std::string &directory, __int64 maxBytes)
+{
+    s_directory = directory;
+    s_maxBytes = maxBytes;
+    if (enabled()) {
+        // create the parents first, CreateDirectory only makes the last level
+        for (std::string::size_type i = s_directory.find_first_of("\\/", 3);
+                i != std::string::npos; i = s_directory.find_first_of("\\/", i + 1)) {
+            CreateDirectoryA(s_directory.substr(0, i).c_str(), NULL);
+        }
+        CreateDirectoryA(s_directory.c_str(), NULL);
+    }
+}
+
+bool PcmCache::enabled()
+{
+    return s_maxBytes > 0;
+}
+
+PcmCache::PcmCache(const std::string &trackPath)
+    : m_trackPath(trackPath)
+    , m_hFile(INVALID_HANDLE_VALUE)
+    , m_hMapping(NULL)
+    , m_pView(NULL)
+    , m_pFrames(NULL)
+    , m_numFrames(0)
+    , m_iChannels(0)
+    , m_iSampleRate(0)
+    , m_ringHead(0)
+    , m_ringTail(0)
+    , m_finishRequested(false)
+    , m_abandonRequested(false)
+    , m_accepting(false)
+{
+}
+
+PcmCache::~PcmCache()
+{
+    // an entry that was finished still gets published, anything else is
+    // dropped
+    abandonWrite();
+    joinWriter();
+    unmap();
+}
+
+/**
+ * Entries are named after a hash of the track path (FNV-1a, 64 bit) so the
+ * cache directory stays flat whatever the tracks are called.
+ */
+std::string PcmCache::entryPath() const
+{
+    unsigned __int64 hash = 14695981039346656037ULL;
+    for (std::string::size_type i = 0; i < m_trackPath.size(); ++i) {
+        hash ^= static_cast<unsigned char>(m_trackPath[i]);
+        hash *= 1099511628211ULL;
+    }
+    char name[17];
+    sprintf_s(name, sizeof(name), "%016llx", hash);
+    return s_directory + "\\" + name + kCacheSuffix;
+}
+
+bool PcmCache::trackStamp(__int64 *size, __int64 *time) const
+{
+    struct _stat64 st;
+    if (_stat64(m_trackPath.c_str(), &st) != 0) {
+        return false;
+    }
+    *size = st.st_size;
+    *time = st.st_mtime;
+    return true;
+}
+
+bool PcmCache::map()
+{
+    unmap();
+    __int64 trackSize(0), trackTime(0);
+    if (!enabled() || !trackStamp(&trackSize, &trackTime)) {
+        return false;
+    }
+    std::string path(entryPath());
+    // FILE_WRITE_ATTRIBUTES so the hit can bump the entry's time through this
+    // handle, another open would fail against our sharing mode
+    m_hFile = CreateFileA(path.c_str(), GENERIC_READ | FILE_WRITE_ATTRIBUTES,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_hFile, &fileSize)
+        || fileSize.QuadPart < static_cast<__int64>(sizeof(Header))) {
+        unmap();
+        return false;
+    }
+    m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_hMapping == NULL) {
+        unmap();
+        return false;
+    }
+    m_pView = MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_pView == NULL) {
+        unmap();
+        return false;
+    }
+
+    const Header *header = static_cast<const Header*>(m_pView);
+    if (memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) != 0
+        || header->version != kCacheVersion
+        || header->trackSize != trackSize || header->trackTime != trackTime
+        || header->channels == 0 || header->numFrames <= 0
+        || fileSize.QuadPart != static_cast<__int64>(sizeof(Header))
+            + header->numFrames * header->channels * static_cast<__int64>(sizeof(SAMPLE))) {
+        if (sDebug) { std::cout << "PcmCache: stale entry for " << m_trackPath << std::endl; }
+        unmap();
+        return false;
+    }
+    m_iChannels = header->channels;
+    m_iSampleRate = header->sampleRate;
+    m_numFrames = header->numFrames;
+    m_pFrames = reinterpret_cast<const SAMPLE*>(header + 1);
+
+    // bump the entry's modification time, eviction uses it as "last used"
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    if (!SetFileTime(m_hFile, NULL, NULL, &now)) {
+        // still a valid hit, the entry just looks older to evict()
+        if (sDebug) {
+            std::cout << "PcmCache: could not touch " << path
+                      << " (error " << GetLastError() << ")" << std::endl;
+        }
+    }
+    if (sDebug) { std::cout << "PcmCache: hit for " << m_trackPath << std::endl; }
+    return true;
+}
+
+void PcmCache::unmap()
+{
+    if (m_pView != NULL) {
+        UnmapViewOfFile(m_pView);
+        m_pView = NULL;
+    }
+    if (m_hMapping != NULL) {
+        CloseHandle(m_hMapping);
+        m_hMapping = NULL;
+    }
+    if (m_hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+    m_pFrames = NULL;
+    m_numFrames = 0;
+}
+
+bool PcmCache::beginWrite(int channels, int sampleRate)
+{
+    abandonWrite();
+    joinWriter();
+    if (!enabled()) {
+        return false;
+    }
+    m_iChannels = channels;
+    m_iSampleRate = sampleRate;
+
+    // Two decoders can be writing the same track at once, so each writer
+    // gets its own temp file; the rename in writerMain() decides who wins.
+    static std::atomic<unsigned int> sWriterCount(0);
+    char unique[32];
+    sprintf_s(unique, sizeof(unique), ".%lu.%u",
+        GetCurrentProcessId(), sWriterCount++);
+    m_tempPath = entryPath() + unique + kCacheTempSuffix;
+
+    m_ring.resize(kRingSamples);
+    m_ringHead = 0;
+    m_ringTail = 0;
+    m_finishRequested = false;
+    m_abandonRequested = false;
+    m_accepting = true;
+    m_writer = std::thread(&PcmCache::writerMain, this);
+    return true;
+}
+
+void PcmCache::append(const SAMPLE *samples, size_t count)
+{
+    if (!m_accepting) {
+        return;
+    }
+    size_t tail = m_ringTail.load(std::memory_order_relaxed);
+    size_t head = m_ringHead.load(std::memory_order_acquire);
+    if (count > kRingSamples - (tail - head)) {
+        // the writer is stalled on the disk; give up on this entry rather
+        // than wait for it
+        abandonWrite();
+        return;
+    }
+    size_t start = tail & (kRingSamples - 1);
+    size_t first = std::min(count, kRingSamples - start);
+    memcpy(&m_ring[start], samples, first * sizeof(SAMPLE));
+    memcpy(&m_ring[0], samples + first, (count - first) * sizeof(SAMPLE));
+    m_ringTail.store(tail + count, std::memory_order_release);
+}
+
+void PcmCache::finishWrite()
+{
+    if (!m_accepting) {
+        return;
+    }
+    m_accepting = false;
+    m_finishRequested.store(true, std::memory_order_release);
+}
+
+void PcmCache::abandonWrite()
+{
+    if (!m_accepting) {
+        return;
+    }
+    m_accepting = false;
+    m_abandonRequested.store(true, std::memory_order_release);
+}
+
+void PcmCache::joinWriter()
+{
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+/** Writes whatever the decoder has appended so far. */
+bool PcmCache::drainRing(std::ofstream &out)
+{
+    size_t head = m_ringHead.load(std::memory_order_relaxed);
+    size_t tail = m_ringTail.load(std::memory_order_acquire);
+    while (head != tail) {
+        size_t start = head & (kRingSamples - 1);
+        size_t count = std::min(tail - head, kRingSamples - start);
+        out.write(reinterpret_cast<const char*>(&m_ring[start]), count * sizeof(SAMPLE));
+        head += count;
+        m_ringHead.store(head, std::memory_order_release);
+    }
+    return !out.fail();
+}
+
+/**
+ * Runs for one entry: streams the ring into the temp file and, once the
+ * decoder has reached the end of the track, fills in the header, renames the
+ * file into place and trims the cache.
+ */
+void PcmCache::writerMain()
+{
+    std::ofstream out(m_tempPath.c_str(), std::ios::binary | std::ios::trunc);
+    // placeholder, filled in below once the length is known
+    Header header;
+    memset(&header, 0, sizeof(header));
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    bool finished(false);
+    while (out) {
+        // read the flags before draining, so everything appended before
+        // finishWrite() is written below
+        finished = m_finishRequested.load(std::memory_order_acquire);
+        bool abandoned(m_abandonRequested.load(std::memory_order_acquire));
+        if (abandoned || !drainRing(out) || finished) {
+            break;
+        }
+        Sleep(kWriterPollMs);
+    }
+
+    __int64 writtenSamples(m_ringHead.load(std::memory_order_relaxed));
+    memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.channels = m_iChannels;
+    header.sampleRate = m_iSampleRate;
+    header.numFrames = writtenSamples / m_iChannels;
+    if (!finished || !out || header.numFrames <= 0
+        || !trackStamp(&header.trackSize, &header.trackTime)) {
+        out.close();
+        remove(m_tempPath.c_str());
+        return;
+    }
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (out.fail()) {
+        remove(m_tempPath.c_str());
+        return;
+    }
+
+    std::string path(entryPath());
+    if (!MoveFileExA(m_tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        remove(m_tempPath.c_str());
+        return;
+    }
+    if (sDebug) {
+        std::cout << "PcmCache: stored " << header.numFrames << " frames for "
+                  << m_trackPath << std::endl;
+    }
+    evict();
+}
+
+/**
+ * Deletes least recently used entries until the cache fits in s_maxBytes.
+ * Entries that are mapped by a playing decoder can't be deleted; they are
+ * skipped and will go on a later pass.
+ */
+void PcmCache::evict()
+{
+    struct Entry {
+        unsigned __int64 lastUsed;
+        __int64 size;
+        std::string path;
+    };
+    std::vector<Entry> entries;
+    __int64 total(0);
+
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((s_directory + "\\*" + kCacheSuffix).c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        Entry entry;
+        entry.lastUsed = (static_cast<unsigned __int64>(data.ftLastWriteTime.dwHighDateTime) << 32)
+            | data.ftLastWriteTime.dwLowDateTime;
+        entry.size = (static_cast<__int64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        entry.path = s_directory + "\\" + data.cFileName;
+        total += entry.size;
+        entries.push_back(entry);
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry &a, const Entry &b) { return a.lastUsed < b.lastUsed; });
+    for (std::vector<Entry>::size_type i = 0; i < entries.size() && total > s_maxBytes; ++i) {
+        if (DeleteFileA(entries[i].path.c_str())) {
+            total -= entries[i].size;
+            if (sDebug) { std::cout << "PcmCache: evicted " << entries[i].path << std::endl; }
+        }
+    }
+}
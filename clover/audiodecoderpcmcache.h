@@ -0,0 +1,99 @@
+/**
+ * \file audiodecoderpcmcache.h
+ * \class PcmCache
+ * \brief Keeps fully decoded tracks on disk as raw float32 PCM so that later
+ * opens can memory-map them instead of decoding again.
+ *
+ * A cache file is a fixed header followed by interleaved float32 frames. It
+ * is tied to the source track by path, size and modification time, so an
+ * edited track is simply decoded (and cached) again. The cache directory is
+ * bounded in size; when a new entry pushes it over the limit, the least
+ * recently used entries are deleted first.
+ *
+ * Writing never touches the disk on the caller's thread: append() only
+ * copies into a fixed ring that a writer thread drains, so a decoder can
+ * fill the cache from the audio callback. If the writer falls so far behind
+ * that the ring fills up, the entry is dropped rather than blocking.
+ */
+
+
+#ifndef AUDIODECODERPCMCACHE_H
+#define AUDIODECODERPCMCACHE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <atomic>
+#include <thread>
+
+#include "audiodecoderbase.h"
+
+class DllExport PcmCache {
+  public:
+    /** Sets the cache directory and its size limit in bytes. A limit of 0
+        disables the cache. The directory should be an absolute path, it is
+        created (with its parents) if it doesn't exist. */
+    static void configure(const std::string &directory, __int64 maxBytes);
+    static bool enabled();
+
+    PcmCache(const std::string &trackPath);
+    ~PcmCache();
+    PcmCache(const PcmCache&) = delete;
+    PcmCache &operator =(const PcmCache&) = delete;
+
+    /** Maps the cache entry for the track, if there is a valid one. */
+    bool map();
+    bool mapped() const { return m_pFrames != NULL; }
+    const SAMPLE *samples() const { return m_pFrames; }
+    __int64 numFrames() const { return m_numFrames; }
+    int channels() const { return m_iChannels; }
+    int sampleRate() const { return m_iSampleRate; }
+
+    /** Starts (or restarts) writing a new entry. Samples passed to append()
+        must be the whole track, in order, starting at frame 0. Waits for a
+        previous entry's writer and starts a thread, so only call it while
+        opening the track, never on the audio callback. */
+    bool beginWrite(int channels, int sampleRate);
+    /** Never blocks; drops the entry if the writer can't keep up. */
+    void append(const SAMPLE *samples, size_t count);
+    /** Hands the entry to the writer thread, which publishes it and trims
+        the cache back under its limit. Never blocks. */
+    void finishWrite();
+    /** Drops the entry. Never blocks, the writer deletes its temp file. */
+    void abandonWrite();
+    bool writing() const { return m_accepting; }
+
+  private:
+    struct Header;
+    std::string entryPath() const;
+    bool trackStamp(__int64 *size, __int64 *time) const;
+    void unmap();
+    void writerMain();
+    bool drainRing(std::ofstream &out);
+    void joinWriter();
+    static void evict();
+
+    static std::string s_directory;
+    static __int64 s_maxBytes;
+
+    std::string m_trackPath;
+    void *m_hFile;
+    void *m_hMapping;
+    const void *m_pView;
+    const SAMPLE *m_pFrames;
+    __int64 m_numFrames;
+    int m_iChannels;
+    int m_iSampleRate;
+
+    // written by the decoder, drained by m_writer
+    std::vector<SAMPLE> m_ring;
+    std::atomic<size_t> m_ringHead;
+    std::atomic<size_t> m_ringTail;
+    std::atomic<bool> m_finishRequested;
+    std::atomic<bool> m_abandonRequested;
+    bool m_accepting;
+    std::thread m_writer;
+    std::string m_tempPath;
+};
+
+#endif // ifndef AUDIODECODERPCMCACHE_H
@@ -0,0 +1,195 @@
+/**
+ * \file audiodecoderwave.cpp
+ * \brief Portable RIFF/WAVE decoder, see audiodecoderwave.h
+ */
+
+#include <string.h>
+
+#include "audiodecoderwave.h"
+
+const unsigned short kFormatPcm = 0x0001;
+const unsigned short kFormatFloat = 0x0003;
+const unsigned short kFormatExtensible = 0xFFFE;
+
+const static bool sDebug = false;
+
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#else
+#define fseek64 fseeko
+#endif
+
+/** RIFF is little endian whatever the host is. */
+static unsigned int le32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
+static unsigned short le16(const unsigned char *p)
+{
+    return static_cast<unsigned short>(p[0] | (p[1] << 8));
+}
+
+AudioDecoderWave::AudioDecoderWave(const std::string filename)
+    : AudioDecoderBase(filename)
+    , m_pFile(NULL)
+    , m_dataOffset(0)
+    , m_numFrames(0)
+    , m_nextFrame(0)
+    , m_iBytesPerSample(0)
+    , m_isFloat(false)
+{
+}
+
+AudioDecoderWave::~AudioDecoderWave()
+{
+    if (m_pFile != NULL) {
+        fclose(m_pFile);
+    }
+}
+
+int AudioDecoderWave::open()
+{
+    m_pFile = fopen(m_filename.c_str(), "rb");
+    if (m_pFile == NULL) {
+        return AUDIODECODER_ERROR;
+    }
+    if (!readHeader()) {
+        if (sDebug) { fprintf(stderr, "AudioDecoderWave: unsupported file %s\n", m_filename.c_str()); }
+        fclose(m_pFile);
+        m_pFile = NULL;
+        return AUDIODECODER_ERROR;
+    }
+    m_iNumSamples = static_cast<int>(m_numFrames * m_iChannels);
+    m_fDuration = static_cast<float>(m_numFrames) / m_iSampleRate;
+    m_iPositionInSamples = 0;
+    return AUDIODECODER_OK;
+}
+
+/**
+ * Walks the chunk list for "fmt " and "data". Anything else (LIST, fact,
+ * cue, ...) is skipped; chunks are padded to an even size.
+ */
+bool AudioDecoderWave::readHeader()
+{
+    unsigned char riff[12];
+    if (fread(riff, 1, sizeof(riff), m_pFile) != sizeof(riff)
+        || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+
+    bool haveFormat = false;
+    long long offset = sizeof(riff);
+    unsigned char chunk[8];
+    while (fread(chunk, 1, sizeof(chunk), m_pFile) == sizeof(chunk)) {
+        unsigned int size = le32(chunk + 4);
+        offset += sizeof(chunk);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[40];
+            if (size < 16 || fread(fmt, 1, size < sizeof(fmt) ? size : sizeof(fmt), m_pFile) < 16) {
+                return false;
+            }
+            unsigned short tag = le16(fmt);
+            if (tag == kFormatExtensible && size >= 26) {
+                tag = le16(fmt + 24); // first two bytes of the sub-format GUID
+            }
+            m_iChannels = le16(fmt + 2);
+            m_iSampleRate = static_cast<int>(le32(fmt + 4));
+            m_iBytesPerSample = le16(fmt + 14) / 8;
+            m_isFloat = tag == kFormatFloat;
+            if ((tag != kFormatPcm && tag != kFormatFloat) || m_iChannels <= 0
+                || m_iSampleRate <= 0 || m_iBytesPerSample < 1 || m_iBytesPerSample > 4
+                || (m_isFloat && m_iBytesPerSample != 4)) {
+                return false;
+            }
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                return false;
+            }
+            m_dataOffset = offset;
+            m_numFrames = size / (m_iBytesPerSample * m_iChannels);
+            return m_numFrames > 0;
+        }
+        offset += size + (size & 1);
+        if (fseek64(m_pFile, offset, SEEK_SET) != 0) {
+            return false;
+        }
+    }
+    return false;
+}
+
+int AudioDecoderWave::seek(int sampleIdx)
+{
+    long long frame = sampleIdx / m_iChannels;
+    if (frame < 0) {
+        frame = 0;
+    } else if (frame > m_numFrames) {
+        frame = m_numFrames;
+    }
+    m_nextFrame = frame;
+    fseek64(m_pFile, m_dataOffset + frame * m_iBytesPerSample * m_iChannels, SEEK_SET);
+    m_iPositionInSamples = static_cast<int>(m_nextFrame * m_iChannels);
+    return m_iPositionInSamples;
+}
+
+int AudioDecoderWave::read(int size, SAMPLE *destination)
+{
+    if (m_pFile == NULL) {
+        return 0;
+    }
+    long long frames = size / m_iChannels;
+    const long long maxFrames = sizeof(m_rawBuffer) / (m_iBytesPerSample * m_iChannels);
+    if (frames > maxFrames) {
+        frames = maxFrames;
+    }
+    if (frames > m_numFrames - m_nextFrame) {
+        frames = m_numFrames - m_nextFrame;
+    }
+    if (frames <= 0) {
+        return 0;
+    }
+
+    size_t samples = fread(m_rawBuffer, m_iBytesPerSample * m_iChannels,
+        static_cast<size_t>(frames), m_pFile) * m_iChannels;
+    const unsigned char *in = m_rawBuffer;
+    switch (m_iBytesPerSample) {
+    case 1: // 8-bit wave data is unsigned
+        for (size_t i = 0; i < samples; ++i) {
+            destination[i] = (in[i] - 128) / 128.0f;
+        }
+        break;
+    case 2:
+        for (size_t i = 0; i < samples; ++i, in += 2) {
+            destination[i] = static_cast<short>(le16(in)) / 32768.0f;
+        }
+        break;
+    case 3:
+        for (size_t i = 0; i < samples; ++i, in += 3) {
+            int v = (in[0] << 8) | (in[1] << 16) | (in[2] << 24);
+            destination[i] = (v >> 8) / 8388608.0f;
+        }
+        break;
+    case 4:
+        if (m_isFloat) {
+            memcpy(destination, in, samples * sizeof(SAMPLE));
+        } else {
+            for (size_t i = 0; i < samples; ++i, in += 4) {
+                destination[i] = static_cast<int>(le32(in)) / 2147483648.0f;
+            }
+        }
+        break;
+    }
+
+    m_nextFrame += samples / m_iChannels;
+    m_iPositionInSamples = static_cast<int>(m_nextFrame * m_iChannels);
+    return static_cast<int>(samples);
+}
+
+std::vector<std::string> AudioDecoderWave::supportedFileExtensions()
+{
+    std::vector<std::string> list;
+    list.push_back("wav");
+    list.push_back("wave");
+    return list;
+}
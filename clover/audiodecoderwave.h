@@ -0,0 +1,43 @@
+/**
+ * \file audiodecoderwave.h
+ * \class AudioDecoderWave
+ * \brief Decodes uncompressed RIFF/WAVE files (8/16/24/32-bit integer PCM and
+ * 32-bit float, including WAVE_FORMAT_EXTENSIBLE) with plain stdio.
+ *
+ * Unlike the Media Foundation decoder it has no platform dependencies, so it
+ * builds on every platform and serves as the reference backend for the
+ * decoder benchmark.
+ */
+
+
+#ifndef AUDIODECODERWAVE_H
+#define AUDIODECODERWAVE_H
+
+#include <stdio.h>
+
+#include "audiodecoderbase.h"
+
+class DllExport AudioDecoderWave : public AudioDecoderBase {
+  public:
+    AudioDecoderWave() = delete;
+    AudioDecoderWave(const std::string filename);
+    ~AudioDecoderWave();
+    AudioDecoderWave(const AudioDecoderWave&) = delete;
+    AudioDecoderWave &operator =(const AudioDecoderWave&) = delete;
+    int open();
+    int seek(int sampleIdx);
+    int read(int size, SAMPLE *buffer);
+    static std::vector<std::string> supportedFileExtensions();
+
+  private:
+    bool readHeader();
+    FILE *m_pFile;
+    long long m_dataOffset;    // byte offset of the first frame
+    long long m_numFrames;
+    long long m_nextFrame;
+    int m_iBytesPerSample;
+    bool m_isFloat;
+    unsigned char m_rawBuffer[kBlockSamples * 4];
+};
+
+#endif // ifndef AUDIODECODERWAVE_H
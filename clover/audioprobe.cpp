@@ -0,0 +1,409 @@
+/**
+ * \file audioprobe.cpp
+ * \brief Header-only format/duration probe, see audioprobe.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "audioprobe.h"
+
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#else
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+// how far past the ID3 tag to look for the first MP3 frame
+const long kMp3SyncWindow = 64 * 1024;
+
+namespace {
+
+/** Owns the FILE and makes short positioned reads. */
+class ProbeFile {
+  public:
+    ProbeFile(const std::string &filename)
+        : m_pFile(fopen(filename.c_str(), "rb"))
+        , m_size(-1)
+    {
+        if (m_pFile != NULL && fseek64(m_pFile, 0, SEEK_END) == 0) {
+            m_size = ftell64(m_pFile);
+        }
+    }
+    ~ProbeFile()
+    {
+        if (m_pFile != NULL) {
+            fclose(m_pFile);
+        }
+    }
+    bool ok() const { return m_pFile != NULL && m_size >= 0; }
+    long long size() const { return m_size; }
+    /** Reads up to 'length' bytes at 'offset', returns how many were read. */
+    size_t readAt(long long offset, void *dest, size_t length)
+    {
+        if (offset < 0 || offset >= m_size || fseek64(m_pFile, offset, SEEK_SET) != 0) {
+            return 0;
+        }
+        return fread(dest, 1, length, m_pFile);
+    }
+    bool readFully(long long offset, void *dest, size_t length)
+    {
+        return readAt(offset, dest, length) == length;
+    }
+
+  private:
+    FILE *m_pFile;
+    long long m_size;
+};
+
+unsigned int be32(const unsigned char *p)
+{
+    return (static_cast<unsigned int>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+unsigned long long be64(const unsigned char *p)
+{
+    return (static_cast<unsigned long long>(be32(p)) << 32) | be32(p + 4);
+}
+
+unsigned int le32(const unsigned char *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+}
+
+unsigned short le16(const unsigned char *p)
+{
+    return static_cast<unsigned short>(p[0] | (p[1] << 8));
+}
+
+//-------------------------------------------------------------------
+// RIFF/WAVE
+//-------------------------------------------------------------------
+
+bool probeWave(ProbeFile &file, AudioProbeInfo *info)
+{
+    unsigned char riff[12];
+    if (!file.readFully(0, riff, sizeof(riff))
+        || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    int blockAlign(0);
+    long long offset = sizeof(riff);
+    unsigned char chunk[8];
+    while (file.readFully(offset, chunk, sizeof(chunk))) {
+        unsigned int size = le32(chunk + 4);
+        offset += sizeof(chunk);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[16];
+            if (size < sizeof(fmt) || !file.readFully(offset, fmt, sizeof(fmt))) {
+                return false;
+            }
+            info->channels = le16(fmt + 2);
+            info->sampleRate = static_cast<int>(le32(fmt + 4));
+            info->bitrate = static_cast<int>(le32(fmt + 8) * 8 / 1000);
+            blockAlign = le16(fmt + 12);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (blockAlign <= 0) {
+                return false;
+            }
+            info->format = AudioProbeInfo::kWave;
+            info->numFrames = size / blockAlign;
+            info->exact = true;
+            return info->channels > 0 && info->sampleRate > 0;
+        }
+        offset += size + (size & 1);
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------
+// MP3
+//-------------------------------------------------------------------
+
+struct Mp3Header {
+    int version;        // 0 = MPEG 2.5, 2 = MPEG 2, 3 = MPEG 1
+    int layer;          // 1, 2, 3
+    int bitrate;        // kbps
+    int sampleRate;
+    int channels;
+    int frameLength;    // bytes
+    int samplesPerFrame;
+};
+
+bool parseMp3Header(const unsigned char *p, Mp3Header *h)
+{
+    static const int kBitrates[2][3][15] = {
+        {   // MPEG 1: layer 1, 2, 3
+            { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+            { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 }
+        },
+        {   // MPEG 2 / 2.5
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 }
+        }
+    };
+    static const int kSampleRates[3] = { 44100, 48000, 32000 };
+
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    int version = (p[1] >> 3) & 3;
+    int layerBits = (p[1] >> 1) & 3;
+    int bitrateIndex = p[2] >> 4;
+    int rateIndex = (p[2] >> 2) & 3;
+    if (version == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15
+        || rateIndex == 3) {
+        return false; // reserved values, or free format which we can't size
+    }
+    h->version = version;
+    h->layer = 4 - layerBits;
+    h->bitrate = kBitrates[version == 3 ? 0 : 1][h->layer - 1][bitrateIndex];
+    h->sampleRate = kSampleRates[rateIndex] >> (version == 3 ? 0 : version == 2 ? 1 : 2);
+    h->channels = (p[3] >> 6) == 3 ? 1 : 2;
+    int padding = (p[2] >> 1) & 1;
+    if (h->layer == 1) {
+        h->samplesPerFrame = 384;
+        h->frameLength = (12 * h->bitrate * 1000 / h->sampleRate + padding) * 4;
+    } else {
+        h->samplesPerFrame = (h->layer == 3 && version != 3) ? 576 : 1152;
+        h->frameLength = h->samplesPerFrame / 8 * h->bitrate * 1000 / h->sampleRate + padding;
+    }
+    return h->frameLength > 4;
+}
+
+/** Size of the ID3v2 tag(s) at the start of the file, 0 if there are none. */
+long long skipId3v2(ProbeFile &file)
+{
+    long long offset(0);
+    unsigned char tag[10];
+    while (file.readFully(offset, tag, sizeof(tag)) && memcmp(tag, "ID3", 3) == 0) {
+        // sizes are "syncsafe": 7 bits per byte
+        long long size = ((tag[6] & 0x7F) << 21) | ((tag[7] & 0x7F) << 14)
+            | ((tag[8] & 0x7F) << 7) | (tag[9] & 0x7F);
+        offset += sizeof(tag) + size + ((tag[5] & 0x10) ? 10 : 0);
+    }
+    return offset;
+}
+
+bool probeMp3(ProbeFile &file, AudioProbeInfo *info)
+{
+    long long start = skipId3v2(file);
+    std::vector<unsigned char> window(kMp3SyncWindow + 4);
+    size_t got = file.readAt(start, &window[0], window.size());
+
+    // Accept a sync only if the frame after it starts with a sync too, random
+    // 0xFFEx bytes in leftover tag data are common.
+    Mp3Header h;
+    long long frameOffset(-1);
+    for (size_t i = 0; i + 4 <= got; ++i) {
+        if (!parseMp3Header(&window[i], &h)) {
+            continue;
+        }
+        unsigned char next[4];
+        Mp3Header h2;
+        if (file.readFully(start + i + h.frameLength, next, sizeof(next))
+            && parseMp3Header(next, &h2) && h2.sampleRate == h.sampleRate) {
+            frameOffset = start + i;
+            break;
+        }
+    }
+    if (frameOffset < 0) {
+        return false;
+    }
+
+    info->format = AudioProbeInfo::kMp3;
+    info->channels = h.channels;
+    info->sampleRate = h.sampleRate;
+    info->bitrate = h.bitrate;
+
+    unsigned char frame[192];
+    memset(frame, 0, sizeof(frame));
+    file.readAt(frameOffset, frame, sizeof(frame));
+
+    // Xing/Info sits right after the side information
+    int sideInfo = h.version == 3 ? (h.channels == 1 ? 17 : 32) : (h.channels == 1 ? 9 : 17);
+    const unsigned char *xing = frame + 4 + sideInfo;
+    if (memcmp(xing, "Xing", 4) == 0 || memcmp(xing, "Info", 4) == 0) {
+        unsigned int flags = be32(xing + 4);
+        const unsigned char *p = xing + 8;
+        if (flags & 1) {
+            long long frames = be32(p);
+            p += 4;
+            if (flags & 2) p += 4;      // byte count
+            if (flags & 4) p += 100;    // TOC
+            if (flags & 8) p += 4;      // quality
+            long long samples = frames * h.samplesPerFrame;
+            // LAME tag: encoder delay and padding, 12 bits each
+            if (p + 24 <= frame + sizeof(frame)
+                && (memcmp(p, "LAME", 4) == 0 || memcmp(p, "Lavc", 4) == 0
+                    || memcmp(p, "Lavf", 4) == 0)) {
+                int delay = (p[21] << 4) | (p[22] >> 4);
+                int padding = ((p[22] & 0x0F) << 8) | p[23];
+                if (samples > delay + padding) {
+                    samples -= delay + padding;
+                }
+            }
+            info->numFrames = samples;
+            info->exact = true;
+            if (info->numFrames > 0) {
+                info->bitrate = static_cast<int>((file.size() - frameOffset) * 8
+                    / info->duration() / 1000);
+            }
+            return true;
+        }
+    }
+
+    // VBRI (Fraunhofer) always sits 32 bytes after the header
+    const unsigned char *vbri = frame + 4 + 32;
+    if (memcmp(vbri, "VBRI", 4) == 0) {
+        info->numFrames = static_cast<long long>(be32(vbri + 14)) * h.samplesPerFrame;
+        info->exact = true;
+        return true;
+    }
+
+    // constant bitrate: estimate from the stream size
+    long long end = file.size();
+    unsigned char tag[3];
+    if (file.readFully(end - 128, tag, sizeof(tag)) && memcmp(tag, "TAG", 3) == 0) {
+        end -= 128; // ID3v1
+    }
+    long long bytes = end - frameOffset;
+    info->numFrames = bytes * 8 * h.sampleRate / (h.bitrate * 1000LL);
+    info->exact = false;
+    return true;
+}
+
+//-------------------------------------------------------------------
+// MP4
+//-------------------------------------------------------------------
+
+/**
+ * Finds the first child atom of 'type' inside [begin, end). On success
+ * [*childBegin, *childEnd) is its payload.
+ */
+bool findAtom(ProbeFile &file, long long begin, long long end, const char *type,
+    long long *childBegin, long long *childEnd)
+{
+    long long offset = begin;
+    unsigned char header[16];
+    while (offset + 8 <= end && file.readFully(offset, header, 8)) {
+        long long size = be32(header);
+        long long headerSize = 8;
+        if (size == 1) {
+            if (!file.readFully(offset + 8, header + 8, 8)) {
+                return false;
+            }
+            size = static_cast<long long>(be64(header + 8));
+            headerSize = 16;
+        } else if (size == 0) {
+            size = end - offset; // extends to the end of its parent
+        }
+        if (size < headerSize || offset + size > end) {
+            return false;
+        }
+        if (memcmp(header + 4, type, 4) == 0) {
+            *childBegin = offset + headerSize;
+            *childEnd = offset + size;
+            return true;
+        }
+        offset += size;
+    }
+    return false;
+}
+
+bool probeMp4Track(ProbeFile &file, long long trakBegin, long long trakEnd,
+    AudioProbeInfo *info)
+{
+    long long mdiaBegin, mdiaEnd, b, e;
+    if (!findAtom(file, trakBegin, trakEnd, "mdia", &mdiaBegin, &mdiaEnd)) {
+        return false;
+    }
+
+    // only sound tracks
+    unsigned char hdlr[12];
+    if (!findAtom(file, mdiaBegin, mdiaEnd, "hdlr", &b, &e)
+        || !file.readFully(b, hdlr, sizeof(hdlr)) || memcmp(hdlr + 8, "soun", 4) != 0) {
+        return false;
+    }
+
+    unsigned char mdhd[32];
+    if (!findAtom(file, mdiaBegin, mdiaEnd, "mdhd", &b, &e)
+        || !file.readFully(b, mdhd, sizeof(mdhd))) {
+        return false;
+    }
+    unsigned long long timescale, duration;
+    if (mdhd[0] == 1) {
+        timescale = be32(mdhd + 20);
+        duration = be64(mdhd + 24);
+    } else {
+        timescale = be32(mdhd + 12);
+        duration = be32(mdhd + 16);
+    }
+
+    // moov/trak/mdia/minf/stbl/stsd, first sample entry (mp4a, alac, ...)
+    unsigned char entry[36];
+    if (!findAtom(file, mdiaBegin, mdiaEnd, "minf", &b, &e)
+        || !findAtom(file, b, e, "stbl", &b, &e)
+        || !findAtom(file, b, e, "stsd", &b, &e)
+        || !file.readFully(b + 8, entry, sizeof(entry))) {
+        return false;
+    }
+    info->channels = (entry[24] << 8) | entry[25];
+    info->sampleRate = static_cast<int>(be32(entry + 32) >> 16);
+    if (timescale == 0 || info->channels <= 0) {
+        return false;
+    }
+    if (info->sampleRate <= 0) {
+        info->sampleRate = static_cast<int>(timescale);
+    }
+    info->format = AudioProbeInfo::kMp4;
+    info->numFrames = static_cast<long long>(duration * info->sampleRate / timescale);
+    info->exact = true;
+    if (info->numFrames > 0) {
+        info->bitrate = static_cast<int>(file.size() * 8 / info->duration() / 1000);
+    }
+    return true;
+}
+
+bool probeMp4(ProbeFile &file, AudioProbeInfo *info)
+{
+    unsigned char ftyp[8];
+    if (!file.readFully(0, ftyp, sizeof(ftyp)) || memcmp(ftyp + 4, "ftyp", 4) != 0) {
+        return false;
+    }
+    // moov may come after mdat; findAtom hops over mdat by its size
+    long long moovBegin, moovEnd;
+    if (!findAtom(file, 0, file.size(), "moov", &moovBegin, &moovEnd)) {
+        return false;
+    }
+    long long offset = moovBegin, trakBegin, trakEnd;
+    while (findAtom(file, offset, moovEnd, "trak", &trakBegin, &trakEnd)) {
+        if (probeMp4Track(file, trakBegin, trakEnd, info)) {
+            return true;
+        }
+        offset = trakEnd;
+    }
+    return false;
+}
+
+} // namespace
+
+bool AudioProbe::probe(const std::string &filename, AudioProbeInfo *info)
+{
+    memset(info, 0, sizeof(*info));
+    ProbeFile file(filename);
+    if (!file.ok()) {
+        return false;
+    }
+    // cheapest and most specific signatures first
+    if (probeWave(file, info) || probeMp4(file, info)) {
+        return true;
+    }
+    memset(info, 0, sizeof(*info));
+    return probeMp3(file, info);
+}
@@ -0,0 +1,52 @@
+/**
+ * \file audioprobe.h
+ * \class AudioProbe
+ * \brief Reads format and duration from container headers only, without
+ * opening a decoder.
+ *
+ * Opening an AudioDecoder to learn a track's length builds a whole Media
+ * Foundation source reader; this parses just enough of the file to answer
+ * the same questions in a few small reads:
+ *  - RIFF/WAVE: "fmt " and "data" chunks
+ *  - MP3: skips ID3v2, then the first frame header plus its Xing/Info
+ *    (with the LAME encoder delay/padding) or VBRI header, falling back to
+ *    a constant bitrate estimate
+ *  - MP4/M4A: the first sound track's mdhd and stsd in moov
+ */
+
+
+#ifndef AUDIOPROBE_H
+#define AUDIOPROBE_H
+
+#include <string>
+
+#include "audiodecoderbase.h"
+
+struct DllExport AudioProbeInfo {
+    enum Format {
+        kUnknown = 0,
+        kWave = 1,
+        kMp3 = 2,
+        kMp4 = 3
+    };
+    Format format;
+    int channels;
+    int sampleRate;
+    long long numFrames;    // per channel
+    int bitrate;            // kbps, 0 if unknown
+    bool exact;             // false when numFrames is a bitrate estimate
+
+    /** Duration in seconds */
+    double duration() const {
+        return sampleRate > 0 ? static_cast<double>(numFrames) / sampleRate : 0.0;
+    }
+};
+
+class DllExport AudioProbe {
+  public:
+    /** Fills 'info' from the file's headers. Returns false if the file can't
+        be read or its container isn't recognised. */
+    static bool probe(const std::string &filename, AudioProbeInfo *info);
+};
+
+#endif // ifndef AUDIOPROBE_H
@@ -4,11 +4,12 @@
 #include <memory>
 #include <chrono>
 #include <locale>
-#include <random>
 #include <thread>
 #include <atomic>
 #include <string>
+#include <vector>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <functional>
 #include <cmath>
@@ -16,6 +17,15 @@
 #include <portaudio.h>
 #include <DxLib.h>
 #include "audiodecoder.h"
+#include "audiodecoderpcmcache.h"
+#include "playlist.hpp"
+#include "mixer.hpp"
+#include "portaudio_output.hpp"
+#include "thread_config.hpp"
+#include "jobs.hpp"
+#include "rng.hpp"
+#include "particle_store.hpp"
+#include "task.hpp"
 #include "bmp.hpp"
 
 //-------- 萔
@@ -179,7 +189,13 @@ using tri_type = alib<float>::trigonometric_function<8, std::allocator<int>>;
 tri_type tri;
 
 //-------- 
-std::mt19937 random(0x77777777u);
+// SĂ̗͂̎킩nƂɐ؂o (Ȃ瓯ʂɂȂ)
+rng::streams random_streams(0x77777777u);
+
+// n
+namespace random_system{
+    const unsigned spark = 0;
+}
 
 //-------- COtBbNnh
 int main_graphic_handle;
@@ -517,137 +533,29 @@ float euclid_norm(float x, float y){
 
 //-------- TEh
 namespace sound_effect{
-    extern PaStream *hit_stream;
-    PaStream *hit_stream;
-    extern std::unique_ptr<AudioDecoder> hit;
-    std::unique_ptr<AudioDecoder> hit;
+    extern mixer::clip hit;
+    mixer::clip hit;
+
+    // ɖ点܂ł̎ct[
+    extern int hit_interval;
+    int hit_interval = 0;
+
+    // 炵Ă玟ɖ点܂ł̃t[
+    extern const int hit_interval_frames;
+    const int hit_interval_frames = 4;
 }
 
-void play_sound();
+//-------- Xg[̃obt@
+extern const unsigned long buffer_length;
+
+void play_sound(std::vector<std::string> paths);
+bool take_playback_failure();
+int sync_audible_spectrum();
+void shutdown_sound();
 void play_hit_sound();
 
 //-------- Q[ŎgIuWFNg
 namespace object{
-    template<class T>
-    struct task{
-        T obj;
-        task *next, *prev;
-        int thread;
-    };
-
-    template<class T>
-    struct object{
-        // ^XNɃR[
-        virtual void ctor(){}
-
-        // ^XNjɃR[
-        virtual void dtor(){}
-
-        // `掞ɃR[
-        virtual void draw() const{}
-
-        // ^XNĂяoɃR[
-        virtual void update(task<T>*&) = 0;
-    };
-
-    template<class T, std::size_t N>
-    class tasklist{
-    private:
-        using task = task<T>;
-        std::size_t size_ = 0;
-        task active_ , *free_;
-        std::array<task, N> arr;
-
-    public:
-        task &active = active_;
-
-        tasklist(){
-            for(int i = 0; i < N - 1; ++i){
-                arr[i].next = &arr[i + 1];
-            }
-            arr[N - 1].next = nullptr;
-            free_ = &arr[0];
-
-            active_.next = &active_;
-            active_.prev = &active_;
-        }
-
-        ~tasklist() = default;
-
-        // ^XN𐶐
-        task *create_task(){
-            if(size_ == N){
-                return nullptr;
-            }
-            ++size_;
-            task *t = free_;
-            free_ = free_->next;
-            active_.next->prev = t;
-            t->next = active_.next;
-            active_.next = t;
-            t->prev = &active_;
-            t->obj.ctor();
-            return t;
-        }
-
-        // ^XN폜
-        task *delete_task(task *t){
-            t->obj.dtor();
-            --size_;
-            task *r = t->prev, *s = t->next;
-            t->prev->next = t->next;
-            if(t->next){
-                t->next->prev = t->prev;
-            }
-            t->next = free_;
-            free_ = t;
-            return r;
-        }
-
-        // NA
-        void clear(){
-            if(size_ == 0){
-                return;
-            }
-            while(active_.next != &active_){
-                delete_task(active_.next);
-            }
-            active_.next = &active_;
-            active_.prev = &active_;
-            size_ = 0;
-        }
-
-        // 
-        bool empty() const{
-            return size_ == 0;
-        }
-
-        // ݂̃TCY
-        std::size_t size() const{
-            return size_;
-        }
-
-        // ^XN
-        void update(){
-            task *t = active_.next;
-            while(t != &active_){
-                static_cast<object<T>*>(&t->obj)->update(t);
-                if(t != &active_){
-                    t = t->next;
-                }
-            }
-        }
-
-        // `^XN
-        void draw() const{
-            task *t = active_.next;
-            while(t != &active_){
-                static_cast<object<T>*>(&t->obj)->draw();
-                t = t->next;
-            }
-        }
-    };
-
     struct point_type{
         coord_type  coord;
         tri_type::angle_t omega;
@@ -661,67 +569,143 @@ namespace object{
         return r;
     }
 
-    // Ή
-    struct spark : public object<spark>{
-        // {p[eBN
-        static const int particle_num = 6;
+    // ^XNXgɉ񂷂Ƃ1Ԃ̍ŏ̐
+    // 菭ȂΕɌĂ񂾃Xbhŉ
+    const std::size_t update_grain = 256;
 
-        using tasklist_type = tasklist<spark, 1024 * particle_num>;
-        static tasklist_type &tasklist(){
-            static tasklist_type t;
-            return t;
-        }
+    // e̐F
+    // update ̓Wũ[J[ł DxLib ̓XbhZ[tł͂Ȃ̂,
+    // GetColor  DxLib_Init ̌ɃCXbh load 1񂾂Ăł
+    namespace colors{
+        unsigned int bullet_arrow = 0, sub_bullet_arrow = 0;
 
-        // W
-        coord_type coord;
+        void load(){
+            bullet_arrow = GetColor(192, 0, 0);
+            sub_bullet_arrow = GetColor(96, 96, 192);
+        }
+    }
 
-        // x
-        coord_type speed;
+    // Ή
+    // ̂Ń^XNɂ, vfƂ̔zɂ܂Ƃ߂Ĉxɓ
+    struct spark{
+        // {p[eBN
+        static const int particle_num = 6;
 
         // 
         static const int length = 3;
 
-        // 
-        int count;
         // ő
         static const int count_max = 30;
 
-        // F
-        unsigned int color;
+        // ɓƂ1Ԃ̍ŏ̐ (1肪ŷő傫)
+        static const std::size_t update_grain = 2048;
+
+        using store_type = particle_store<1024 * particle_num>;
+
+        // ΉԂ̓ꕨ (game_world )
+        class pool_type{
+        public:
+            pool_type() : store_(count_max), random_(random_streams.get(random_system::spark)){}
+
+            // c  particle_num ̉ΉԂU炷
+            // ̏ł͗\񂷂邾, update ̍ŏɂ܂Ƃ߂Đ
+            // ɉ񂵂Ă update Ăׂ悤 jobs::partition() Ƃɕė߂
+            void emit(const coord_type &c, unsigned int color){
+                emit_request e;
+                e.x = c[0];
+                e.y = c[1];
+                e.color = color;
+                requests_[jobs::partition()].push_back(e);
+            }
 
-        void ctor() override{
-            count = 0;
+            void update(jobs::scheduler &s){
+                flush();
+                store_.update(s, update_grain);
+            }
 
-            static const float r = 25.0f / count_max;
-            tri_type::angle_t omega = tri_type::pi * ((random() % 64) - 32) / 32;
-            speed[0] = tri.cos(omega) * r;
-            speed[1] = tri.sin(omega) * r;
-        }
+            void draw() const{
+                for(std::size_t i = 0; i < store_.size(); ++i){
+                    const int x = static_cast<int>(offset_x + store_.x(i)), y = static_cast<int>(offset_y + store_.y(i));
+                    const int ex = static_cast<int>(offset_x + store_.x(i) + store_.vx(i) * length), ey = static_cast<int>(offset_y + store_.y(i) + store_.vy(i) * length);
+                    DrawLine(x, y, ex, ey, store_.color(i));
+                    DrawPixel(ex, ey, store_.color(i));
+                }
+            }
 
-        void draw() const override{
-            DrawLine(
-                static_cast<int>(offset_x + coord[0]),
-                static_cast<int>(offset_y + coord[1]),
-                static_cast<int>(offset_x + coord[0] + speed[0] * length),
-                static_cast<int>(offset_y + coord[1] + speed[1] * length),
-                color
-            );
-            DrawPixel(
-                static_cast<int>(offset_x + coord[0] + speed[0] * length),
-                static_cast<int>(offset_y + coord[1] + speed[1] * length),
-                color
-            );
-        }
+            void clear(){
+                for(std::vector<emit_request> &lane : requests_){
+                    lane.clear();
+                }
+                store_.clear();
+            }
 
-        void update(task<spark> *&t) override{
-            ++count;
-            if(count >= count_max){
-                t = tasklist().delete_task(t);
-                return;
+            // Œ蒷Ȃ̂Ŏ͖̂
+            // ͍ŏ蒼̂, V[ƂɓʂɂȂ
+            void release(arena&){
+                clear();
+                store_.reset_stats();
+                random_ = rng::xoshiro128x4(random_streams.get(random_system::spark));
             }
 
-            coord[0] += speed[0];
-            coord[1] += speed[1];
+            pool_stats stats() const{
+                pool_stats s;
+                s.size = store_.size();
+                s.capacity = s.limit = store_.max_size();
+                s.high_water = store_.high_water();
+                s.spawned = store_.spawned();
+                s.drops = store_.drops();
+                return s;
+            }
+
+            const store_type &particles() const{
+                return store_;
+            }
+
+        private:
+            // U炷\
+            struct emit_request{
+                float x, y;
+                unsigned int color;
+            };
+
+            // Ԃ̔ԍ, \񂵂ɎU炷
+            // ̗͑SĂ̗\̕܂Ƃ߂Ĉ
+            void flush(){
+                static const float r = 25.0f / count_max;
+                std::size_t n = 0;
+                for(const std::vector<emit_request> &lane : requests_){
+                    n += lane.size();
+                }
+                draws_.resize(n * particle_num);
+                random_.fill(draws_.data(), draws_.size());
+
+                const std::uint32_t *d = draws_.data();
+                for(std::vector<emit_request> &lane : requests_){
+                    for(const emit_request &e : lane){
+                        // tȂ spawn ̂Ă𐔂
+                        for(int i = 0; i < particle_num; ++i){
+                            tri_type::angle_t omega = tri_type::pi * (static_cast<int>(rng::below(*d++, 64)) - 32) / 32;
+                            store_.spawn(e.x, e.y, tri.cos(omega) * r, tri.sin(omega) * r, e.color);
+                        }
+                    }
+                    lane.clear();
+                }
+            }
+
+            store_type store_;
+            std::array<std::vector<emit_request>, jobs::max_partitions> requests_;
+            rng::xoshiro128x4 random_;
+            std::vector<std::uint32_t> draws_;
+        };
+
+        static pool_type &pool();
+
+        static const char *name(){
+            return "spark";
+        }
+
+        static void emit(const coord_type &c, unsigned int color){
+            pool().emit(c, color);
         }
     };
 
@@ -865,10 +849,16 @@ namespace object{
 
     // obgA[
     struct bullet_arrow : public object<bullet_arrow>{
-        using tasklist_type = tasklist<bullet_arrow, 256 * 3>;
+        // 256 ₵, 1t[ŉ񂵐؂鐔Ŏ~߂
+        using tasklist_type = chunked_tasklist<bullet_arrow, 256, 256 * 3 * 8>;
+        using pool_type = task_pool<tasklist_type, update_grain>;
+        static pool_type &pool();
+
+        static const char *name(){
+            return "bullet_arrow";
+        }
         static tasklist_type &tasklist(){
-            static tasklist_type t;
-            return t;
+            return pool().list;
         }
 
         // W
@@ -885,37 +875,30 @@ namespace object{
         static const int phase_max = 1;
 
         // F
-        static unsigned int color(){ return GetColor(192, 0, 0); }
+        static unsigned int color(){ return colors::bullet_arrow; }
 
         // pxݒ肷
         void set_omega(){
             omega = tri.atan2(speed[1], speed[0]);
         }
 
-        void ctor() override{
+        void ctor(){
             phase = 0;
         }
 
-        void draw() const override{
+        void draw() const{
             fill_bullet_arrow_draw(coord, omega, color());
         }
 
-        void update(task<bullet_arrow> *&t) override{
+        bool update(){
             coord[0] += speed[0];
             coord[1] += speed[1];
 
+            bool alive = true;
             if(coord[0] < 0.0 || coord[0] >= field_width || coord[1] < 0.0 || coord[1] >= field_height){
-                task<spark> *v[spark::particle_num];
-                for(int i = 0; i < spark::particle_num; ++i){
-                    v[i] = spark::tasklist().create_task();
-                    if(v[i]){
-                        v[i]->obj.color = color();
-                    }
-                }
-
                 ++phase;
                 if(phase >= phase_max){
-                    t = tasklist().delete_task(t);
+                    alive = false;
                 }else{
                     bool ref[2] = { false };
                     if(coord[0] < 0.0){
@@ -942,22 +925,23 @@ namespace object{
                     }
                 }
 
-                for(int i = 0; i < spark::particle_num; ++i){
-                    if(v[i]){
-                        v[i]->obj.coord[0] = coord[0];
-                        v[i]->obj.coord[1] = coord[1];
-                    }
-                }
+                spark::emit(coord, color());
             }
+            return alive;
         }
     };
 
     // TuobgA[
     struct sub_bullet_arrow : public object<sub_bullet_arrow>{
-        using tasklist_type = tasklist<sub_bullet_arrow, 256>;
+        using tasklist_type = chunked_tasklist<sub_bullet_arrow, 256, 256 * 8>;
+        using pool_type = task_pool<tasklist_type, update_grain>;
+        static pool_type &pool();
+
+        static const char *name(){
+            return "sub_bullet_arrow";
+        }
         static tasklist_type &tasklist(){
-            static tasklist_type t;
-            return t;
+            return pool().list;
         }
 
         // W
@@ -975,71 +959,75 @@ namespace object{
         tri_type::angle_t omega;
 
         // F
-        static unsigned int color(){ return GetColor(96, 96, 192); }
+        static unsigned int color(){ return colors::sub_bullet_arrow; }
 
         // pxݒ肷
         void set_omega(){
             omega = tri.atan2(speed[1], speed[0]);
         }
 
-        void draw() const override{
+        void draw() const{
             basic_bullet_arrow_draw(coord, omega, color());
         }
 
-        void update(task<sub_bullet_arrow> *&t) override{
+        bool update(){
             coord[0] += speed[0];
             coord[1] += speed[1];
             
             if(coord[0] < 0.0 || coord[0] >= field_width || coord[1] < 0.0 || coord[1] >= field_height){
-                t = tasklist().delete_task(t);
-
-                task<bullet_arrow> *u = bullet_arrow::tasklist().create_task();
-                task<spark> *v[spark::particle_num];
-                for(int i = 0; i < spark::particle_num; ++i){
-                    v[i] = spark::tasklist().create_task();
-                    if(v[i]){
-                        v[i]->obj.color = color();
-                    }
+                // ˕Ԃe\񂷂 (tȂ apply Ŏ̂Ă drops ɐ)
+                bullet_arrow &u = bullet_arrow::pool().commands.spawn();
+                u.coord[0] = coord[0];
+                u.coord[1] = coord[1];
+
+                bool ref[2] = { false };
+                if(u.coord[0] < 0.0){
+                    ref[0] = true;
+                    u.coord[0] = 0.0;
+                }else if(u.coord[0] >= field_width){
+                    ref[0] = true;
+                    u.coord[0] = field_width;
                 }
-                if(u){
-                    u->obj.coord[0] = coord[0];
-                    u->obj.coord[1] = coord[1];
-
-                    bool ref[2] = { false };
-                    if(u->obj.coord[0] < 0.0){
-                        ref[0] = true;
-                        u->obj.coord[0] = 0.0;
-                    }else if(u->obj.coord[0] >= field_width){
-                        ref[0] = true;
-                        u->obj.coord[0] = field_width;
-                    }
-                    if(u->obj.coord[1] < 0.0){
-                        ref[1] = true;
-                        u->obj.coord[1] = 0.0;
-                    }else if(u->obj.coord[1] >= field_width){
-                        ref[1] = true;
-                        u->obj.coord[1] = field_width;
-                    }
-                    for(int i = 0; i < 2; ++i){
-                        if(ref[i]){
-                            u->obj.speed[i] = -speed[i];
-                        }else{
-                            u->obj.speed[i] = +speed[i];
-                        }
-                    }
-                    u->obj.set_omega();
-
-                    for(int i = 0; i < spark::particle_num; ++i){
-                        if(v[i]){
-                            v[i]->obj.coord[0] = u->obj.coord[0];
-                            v[i]->obj.coord[1] = u->obj.coord[1];
-                        }
+                if(u.coord[1] < 0.0){
+                    ref[1] = true;
+                    u.coord[1] = 0.0;
+                }else if(u.coord[1] >= field_width){
+                    ref[1] = true;
+                    u.coord[1] = field_width;
+                }
+                for(int i = 0; i < 2; ++i){
+                    if(ref[i]){
+                        u.speed[i] = -speed[i];
+                    }else{
+                        u.speed[i] = +speed[i];
                     }
                 }
+                u.set_omega();
+
+                spark::emit(u.coord, color());
+                return false;
             }
+            return true;
         }
     };
 
+    // SĂ̎ނ̃IuWFNg
+    // ׂɉ񂷂̂, \񂷂鑤󂯎鑤Oɒu
+    using world_type = world<sub_bullet_arrow, bullet_arrow, spark>;
+    world_type game_world;
+
+    inline spark::pool_type &spark::pool(){
+        return game_world.get<spark>();
+    }
+
+    inline bullet_arrow::pool_type &bullet_arrow::pool(){
+        return game_world.get<bullet_arrow>();
+    }
+
+    inline sub_bullet_arrow::pool_type &sub_bullet_arrow::pool(){
+        return game_world.get<sub_bullet_arrow>();
+    }
+
     // qbgJEg
     struct hitcount_type{
         int count;
@@ -1089,30 +1077,20 @@ namespace object{
         }
 
         void collision(){
-            auto &list_manager_bullet_arrow = bullet_arrow::tasklist();
-            auto *t = list_manager_bullet_arrow.active.next;
             bool hit_flag = false;
-            while(t != &list_manager_bullet_arrow.active){
-                bool d = t->obj.coord[0] >= coord[0] && t->obj.coord[0] - 1.0 <= coord[0];
-                d = d || t->obj.coord[0] >= coord[0] - 1.0 && t->obj.coord[0] - 1.0 <= coord[0] - 1.0;
-                bool e = t->obj.coord[1] >= coord[1] && t->obj.coord[1] - 1.0 <= coord[1];
-                e = e || t->obj.coord[1] >= coord[1] - 1.0 && t->obj.coord[1] - 1.0 <= coord[1] - 1.0;
+            bullet_arrow::tasklist().remove_if([&](const bullet_arrow &b){
+                bool d = b.coord[0] >= coord[0] && b.coord[0] - 1.0 <= coord[0];
+                d = d || b.coord[0] >= coord[0] - 1.0 && b.coord[0] - 1.0 <= coord[0] - 1.0;
+                bool e = b.coord[1] >= coord[1] && b.coord[1] - 1.0 <= coord[1];
+                e = e || b.coord[1] >= coord[1] - 1.0 && b.coord[1] - 1.0 <= coord[1] - 1.0;
                 if(d && e){
-                    t = list_manager_bullet_arrow.delete_task(t);
                     ++hitcount.count;
                     hit_flag = true;
-                    task<spark> *v[spark::particle_num];
-                    for(int i = 0; i < spark::particle_num; ++i){
-                        v[i] = spark::tasklist().create_task();
-                        if(v[i]){
-                            v[i]->obj.coord[0] = coord[0];
-                            v[i]->obj.coord[1] = coord[1];
-                            v[i]->obj.color = bullet_arrow::color();
-                        }
-                    }
+                    spark::emit(coord, bullet_arrow::color());
+                    return true;
                 }
-                t = t->next;
-            }
+                return false;
+            });
             if(hit_flag){
                 play_hit_sound();
             }
@@ -1279,40 +1257,43 @@ namespace object{
     extern volatile float peek_spectrum[2][256];
     volatile float peek_spectrum[2][256] = { 0.0 };
 
-    // ŋ߂̃t[̃XyNg̃LbV
+    // ŋ߂̃t[̃XyNg̃LbV (256 , game_main V[̃ɒu)
     const int spectrum_cache_num = 3;
-    std::unique_ptr<float[]> spectrum_cache[2][spectrum_cache_num];
+    float *spectrum_cache[2][spectrum_cache_num];
 
     void update_spectrum_cache(const coord_type &origin){
+        // Ă鉹̉͌ʂg
+        sync_audible_spectrum();
+
         for(int i = 0; i < spectrum_cache_num - 1; ++i){
             for(int j = 0; j < 256; ++j){
-                spectrum_cache[0][i].get()[j] = spectrum_cache[0][i + 1].get()[j];
-                spectrum_cache[1][i].get()[j] = spectrum_cache[1][i + 1].get()[j];
+                spectrum_cache[0][i][j] = spectrum_cache[0][i + 1][j];
+                spectrum_cache[1][i][j] = spectrum_cache[1][i + 1][j];
             }
         }
         for(int i = 0; i < 256; ++i){
-            spectrum_cache[0][spectrum_cache_num - 1].get()[i] = peek_spectrum[0][i];
-            spectrum_cache[1][spectrum_cache_num - 1].get()[i] = peek_spectrum[1][i];
+            spectrum_cache[0][spectrum_cache_num - 1][i] = peek_spectrum[0][i];
+            spectrum_cache[1][spectrum_cache_num - 1][i] = peek_spectrum[1][i];
         }
 
         for(int spectrum_count = 0; spectrum_count < 256; ++spectrum_count){
             for(int i = 0; i < 2; ++i){
                 float orth_spectrum[spectrum_cache_num];
                 for(int j = 0; j < spectrum_cache_num; ++j){
-                    orth_spectrum[j] = spectrum_cache[i][j].get()[spectrum_count];
+                    orth_spectrum[j] = spectrum_cache[i][j][spectrum_count];
                 }
                 std::sort(orth_spectrum, orth_spectrum + spectrum_cache_num - 1);
                 float v = std::log(peek_spectrum[i][spectrum_count]) / std::log(orth_spectrum[0]);
                 if(orth_spectrum[0] > 0.0 && v >= 2.0){
-                    task<sub_bullet_arrow> *t = sub_bullet_arrow::tasklist().create_task();
+                    sub_bullet_arrow *t = sub_bullet_arrow::tasklist().create_task();
                     if(t){
-                        t->obj.coord[0] = origin[0];
-                        t->obj.coord[1] = origin[1];
+                        t->coord[0] = origin[0];
+                        t->coord[1] = origin[1];
 
-                        t->obj.speed[0] = (i == 0 ? +1 : -1) * tri.cos(spectrum_count) * sub_bullet_arrow::speed_coe();
-                        t->obj.speed[1] = (i == 0 ? +1 : -1) * tri.sin(spectrum_count) * sub_bullet_arrow::speed_coe();
+                        t->speed[0] = (i == 0 ? +1 : -1) * tri.cos(spectrum_count) * sub_bullet_arrow::speed_coe();
+                        t->speed[1] = (i == 0 ? +1 : -1) * tri.sin(spectrum_count) * sub_bullet_arrow::speed_coe();
 
-                        t->obj.set_omega();
+                        t->set_omega();
                     }
                 }
             }
@@ -1329,13 +1310,38 @@ public:
 };
 
 namespace clover_system{
-    std::atomic<bool> now_playing;
     bool on_dd = false;
-    std::unique_ptr<AudioDecoder> decoder;
-    PaStream *stream = nullptr;
-    std::thread sound_thread;
+    playlist::engine music;
+    mixer::engine audio;
+    bool show_audio_stats = false;
+    std::unique_ptr<jobs::scheduler> job_scheduler;
     fps_manager fps;
-    std::unique_ptr<game_loop> current_loop;
+
+    // V[̊Ԃg (V[g, IuWFNg̃v[, LbV)
+    // V[؂ւƂɂ܂Ƃ߂ĕԂ
+    const std::size_t scene_memory_size = 16 << 20;
+    std::unique_ptr<arena> scene_memory;
+
+    // -stats-csv Ŏw肵ƂJ. 1t[1s
+    std::ofstream stats_csv;
+
+    // V[ scene_memory ɒû, jĂ͕ԂȂ
+    struct scene_deleter{
+        void operator ()(game_loop *p) const{
+            p->~game_loop();
+        }
+    };
+    std::unique_ptr<game_loop, scene_deleter> current_loop;
+
+    // V[؂ւ
+    // ÕV[j, v[ƃV[̃܂Ƃ߂ĎĂ玟̃V[u
+    template<class Scene>
+    void change_scene(){
+        current_loop.reset();
+        object::game_world.release(*scene_memory);
+        scene_memory->reset();
+        current_loop.reset(new(scene_memory->allocate<Scene>()) Scene());
+    }
     std::vector<std::function<void()>> action_queue;
 }
 
@@ -1394,6 +1400,67 @@ void draw_progress(){
     );
 }
 
+// I[fBIR[obŇvʂ̕` (F3 Ő؂ւ)
+void draw_audio_stats(){
+    if(!clover_system::show_audio_stats){
+        return;
+    }
+    const mixer::callback_stats s = clover_system::audio.stats();
+    const unsigned int color = GetColor(0xC0, 0, 0);
+    const int line_height = 16;
+    int y = 0;
+    DrawFormatString(
+        0, y, color, "callbacks %u  underflow %u  overflow %u  cpu %.1f%%",
+        static_cast<unsigned>(s.callbacks), static_cast<unsigned>(s.underflows), static_cast<unsigned>(s.overflows), s.cpu_load * 100.0
+    );
+    y += line_height;
+    DrawFormatString(
+        0, y, color, "last %d frames  %.2fms (music %.2fms)  max %.0f%%",
+        s.last_frames, s.last_seconds * 1000.0, s.last_music_seconds * 1000.0, s.max_load * 100.0
+    );
+    y += line_height;
+
+    // ߐ؂ɑ΂鏈Ԃ̕z
+    for(int i = 0; i < mixer::callback_stats::load_bins; ++i){
+        double rate = s.callbacks > 0 ? static_cast<double>(s.histogram[i]) / s.callbacks : 0.0;
+        if(i < mixer::callback_stats::load_bins - 1){
+            DrawFormatString(0, y, color, "%3d%%", i * 10);
+        }else{
+            DrawFormatString(0, y, color, "over");
+        }
+        DrawBox(40, y + 2, 40 + static_cast<int>(rate * 200), y + line_height - 2, color, TRUE);
+        y += line_height;
+    }
+
+    // Xbh̗DxƃRÅ蓖
+    for(int i = 0; i < static_cast<int>(thread_config::role::num); ++i){
+        const thread_config::role r = static_cast<thread_config::role>(i);
+        const thread_config::result res = thread_config::last_result(r);
+        DrawFormatString(
+            0, y, color, "%s: %s%s %s",
+            thread_config::name(r), res.realtime ? "realtime" : "normal", res.pinned ? " pinned" : "", res.message.c_str()
+        );
+        y += line_height;
+    }
+
+    // ނƂ̃v[̎gp, tŎ̂Ă̐ update/draw ̎
+    for(const object::type_stats &t : object::game_world.stats()){
+        DrawFormatString(
+            0, y, color, "%s %u/%u (limit %u) peak %u spawned %u dropped %u  update %.2fms draw %.2fms",
+            t.name, static_cast<unsigned>(t.pool.size), static_cast<unsigned>(t.pool.capacity), static_cast<unsigned>(t.pool.limit), static_cast<unsigned>(t.pool.high_water),
+            static_cast<unsigned>(t.pool.spawned), static_cast<unsigned>(t.pool.drops), t.update_seconds * 1000.0, t.draw_seconds * 1000.0
+        );
+        y += line_height;
+    }
+
+    const arena &memory = *clover_system::scene_memory;
+    DrawFormatString(
+        0, y, color, "scene memory %uKB / %uKB%s%s",
+        static_cast<unsigned>(memory.allocated() >> 10), static_cast<unsigned>(memory.reserved() >> 10),
+        memory.huge() ? " huge" : "", memory.overflowed() ? " overflowed" : ""
+    );
+}
+
 // S̕`
 void draw_logo(){
     DrawGraph((screen_width - pattern::title->width()) / 2, (screen_height - pattern::title->height()) / 2, pattern::title->get(), FALSE);
@@ -1405,9 +1472,7 @@ namespace scene{
     class title : public game_loop{
     public:
         title(){
-            object::sub_bullet_arrow::tasklist().clear();
-            object::bullet_arrow::tasklist().clear();
-            object::spark::tasklist().clear();
+            object::game_world.clear();
         }
 
         bool update() override{
@@ -1417,9 +1482,7 @@ namespace scene{
             }
 
             //-------- proc
-            object::sub_bullet_arrow::tasklist().update();
-            object::bullet_arrow::tasklist().update();
-            object::spark::tasklist().update();
+            object::game_world.update(*clover_system::job_scheduler);
 
             ++count;
             omega += tri.pi * 2 / 256;
@@ -1429,15 +1492,15 @@ namespace scene{
             if(count >= 2){
                 count = 0;
                 for(int i = 0; i < 2; ++i){
-                    object::task<object::sub_bullet_arrow> *t = object::sub_bullet_arrow::tasklist().create_task();
+                    object::sub_bullet_arrow *t = object::sub_bullet_arrow::tasklist().create_task();
                     if(t){
-                        t->obj.coord[0] = field_width / 2.0;
-                        t->obj.coord[1] = field_height / 2.0;
+                        t->coord[0] = field_width / 2.0;
+                        t->coord[1] = field_height / 2.0;
 
-                        t->obj.speed[0] = (i == 0 ? +1 : -1) * tri.cos(omega - tri.pi) * object::sub_bullet_arrow::speed_coe();
-                        t->obj.speed[1] = (i == 0 ? +1 : -1) * tri.sin(omega - tri.pi) * object::sub_bullet_arrow::speed_coe();
+                        t->speed[0] = (i == 0 ? +1 : -1) * tri.cos(omega - tri.pi) * object::sub_bullet_arrow::speed_coe();
+                        t->speed[1] = (i == 0 ? +1 : -1) * tri.sin(omega - tri.pi) * object::sub_bullet_arrow::speed_coe();
 
-                        t->obj.set_omega();
+                        t->set_omega();
                     }
                 }
             }
@@ -1448,9 +1511,7 @@ namespace scene{
             DrawBox(0, 0, screen_width, screen_height, GetColor(0xFF, 0xFF, 0xFF), TRUE);
 
             draw_field();
-            object::sub_bullet_arrow::tasklist().draw();
-            object::bullet_arrow::tasklist().draw();
-            object::spark::tasklist().draw();
+            object::game_world.draw();
             draw_logo();
 
             SetDrawScreen(DX_SCREEN_FRONT);
@@ -1469,9 +1530,13 @@ namespace scene{
     class game_main : public game_loop{
     public:
         game_main(){
-            object::sub_bullet_arrow::tasklist().clear();
-            object::bullet_arrow::tasklist().clear();
-            object::spark::tasklist().clear();
+            object::game_world.clear();
+            for(auto &cache : object::spectrum_cache){
+                for(float *&c : cache){
+                    c = clover_system::scene_memory->allocate<float>(256);
+                    std::fill(c, c + 256, 0.0f);
+                }
+            }
             object::hitcount.ctor();
             object::player.ctor();
         }
@@ -1481,12 +1546,13 @@ namespace scene{
             if(input_manager.push(keys::escape) || ProcessMessage() == -1){
                 return false;
             }
+            if(input_manager.push(keys::f3)){
+                clover_system::show_audio_stats = !clover_system::show_audio_stats;
+            }
 
             //-------- proc
             object::player.update();
-            object::sub_bullet_arrow::tasklist().update();
-            object::bullet_arrow::tasklist().update();
-            object::spark::tasklist().update();
+            object::game_world.update(*clover_system::job_scheduler);
 
             object::update_spectrum_cache(object::player.coord);
 
@@ -1501,10 +1567,17 @@ namespace scene{
 
             // IuWFNg̕`
             object::hitcount.draw();
-            object::sub_bullet_arrow::tasklist().draw();
+            object::game_world.draw<object::sub_bullet_arrow>();
             object::player.draw();
-            object::bullet_arrow::tasklist().draw();
-            object::spark::tasklist().draw();
+            object::game_world.draw<object::bullet_arrow>();
+            object::game_world.draw<object::spark>();
+
+            // ̃t[ update/draw ̎ԂĂ珑
+            if(clover_system::stats_csv.is_open()){
+                object::game_world.write_csv(clover_system::stats_csv);
+            }
+
+            draw_audio_stats();
 
             // FPS̕\
             //{
@@ -1533,28 +1606,24 @@ LRESULT CALLBACK window_proc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp){
             HDROP hdrop = (HDROP)wp;
             UINT u_fileno = DragQueryFile(hdrop, 0xFFFFFFFF, NULL, 0);
             if(u_fileno > 0){
-                char path[4192];
-                DragQueryFile(hdrop, 0, path, sizeof(path));
-                clover_system::now_playing = false;
-                if(clover_system::sound_thread.joinable()){
-                    clover_system::sound_thread.join();
-                }
-                clover_system::decoder.reset(new AudioDecoder(path));
-                clover_system::on_dd = clover_system::decoder->open() != -1;
-                if(!clover_system::on_dd){
-                    clover_system::action_queue.push_back([](){
-                        clover_system::current_loop.reset(new scene::title());
-                    });
-                }else{
-                    WINDOWINFO info;
-                    GetWindowInfo(GetMainWindowHandle(), &info);
-                    SetWindowPos(GetMainWindowHandle(), HWND_TOP, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE);
-                    SetFocus(GetMainWindowHandle());
-                    clover_system::sound_thread = std::move(std::thread(play_sound));
-                    clover_system::action_queue.push_back([](){
-                        clover_system::current_loop.reset(new scene::game_main());
-                    });
+                // hbvꂽɃvCXgɂ
+                std::vector<std::string> paths;
+                for(UINT i = 0; i < u_fileno; ++i){
+                    char path[4192];
+                    DragQueryFile(hdrop, i, path, sizeof(path));
+                    paths.push_back(path);
                 }
+                // Ȃ̐؂ւ͍ĐZbVɔC (ł͑҂Ȃ)
+                // 1ȂJȂꍇ take_playback_failure Ń^Cgɖ߂
+                clover_system::on_dd = true;
+                WINDOWINFO info;
+                GetWindowInfo(GetMainWindowHandle(), &info);
+                SetWindowPos(GetMainWindowHandle(), HWND_TOP, 0, 0, 0, 0, SWP_NOSIZE | SWP_NOMOVE);
+                SetFocus(GetMainWindowHandle());
+                play_sound(std::move(paths));
+                clover_system::action_queue.push_back([](){
+                    clover_system::change_scene<scene::game_main>();
+                });
             }
             DragFinish(hdrop);
         }
@@ -1567,21 +1636,127 @@ LRESULT CALLBACK window_proc(HWND hwnd, UINT msg, WPARAM wp, LPARAM lp){
     return 0;
 }
 
+//-------- V[̃̐ݒ
+// R}hCŎw肷
+//   -huge-pages       : 傫y[Wg (Εʂ̃y[W)
+void configure_memory(const char *cmd){
+    unsigned options = arena::prefault;
+    std::istringstream iss(cmd ? cmd : "");
+    std::string token;
+    while(iss >> token){
+        if(token == "-huge-pages"){
+            options |= arena::huge_pages;
+        }
+    }
+    clover_system::scene_memory.reset(new arena(clover_system::scene_memory_size, options));
+}
+
+//-------- v̏o
+// R}hCŎw肷
+//   -stats-csv <path> : ނƂ̃v[̎gpʂƎԂ𖈃t[ path ɏ
+void configure_stats(const char *cmd){
+    std::istringstream iss(cmd ? cmd : "");
+    std::string token, path;
+    while(iss >> token){
+        if(token == "-stats-csv"){
+            iss >> path;
+        }
+    }
+    if(path.empty()){
+        return;
+    }
+    clover_system::stats_csv.open(path, std::ios::trunc);
+    if(clover_system::stats_csv.is_open()){
+        object::game_world.write_csv_header(clover_system::stats_csv);
+    }
+}
+
+//-------- Xbh̐ݒ
+// R}hCŎw肷
+//   -no-rt            : I[fBĨXbhA^CDxɂȂ
+//   -worker-rt        : Ȃ̓ǂݍ݂̃XbhA^CDxɂ
+//   -audio-core <n>   : I[fBIR[obNuRA
+//   -worker-core <n>  : Ȃ̓ǂݍ݂̃XbhuRA
+//   -game-core <n>    : Q[̃XbhuRA
+//   -jobs <n>         : IuWFNgɉ񂷃[J[̐ (0 ȂQ[̃Xbh)
+void configure_threads(const char *cmd){
+    thread_config::settings audio, worker, game;
+    // Wũ[J[. ł̓Q[, I[fBI, Ȃ̓ǂݍ݂̕󂯂Ă
+    int job_threads = std::max(0, thread_config::core_count() - 3);
+    audio.realtime = true;
+    audio.priority = 70;
+    worker.priority = 40;
+
+    std::istringstream iss(cmd ? cmd : "");
+    std::string token;
+    while(iss >> token){
+        try{
+            std::string value;
+            if(token == "-no-rt"){
+                audio.realtime = false;
+            }else if(token == "-worker-rt"){
+                worker.realtime = true;
+            }else if(token == "-audio-core" && iss >> value){
+                audio.core = boost::lexical_cast<int>(value);
+            }else if(token == "-worker-core" && iss >> value){
+                worker.core = boost::lexical_cast<int>(value);
+            }else if(token == "-game-core" && iss >> value){
+                game.core = boost::lexical_cast<int>(value);
+            }else if(token == "-jobs" && iss >> value){
+                job_threads = boost::lexical_cast<int>(value);
+            }
+        }catch(boost::bad_lexical_cast&){
+            // ǂ߂Ȃl͖
+        }
+    }
+
+    thread_config::configure(thread_config::role::audio, audio);
+    thread_config::configure(thread_config::role::worker, worker);
+    thread_config::configure(thread_config::role::game, game);
+
+    clover_system::job_scheduler.reset(new jobs::scheduler(job_threads));
+}
+
+//-------- LbV̒uꏊ
+// ƃfBNgɍEȂ悤 %LOCALAPPDATA%\clover\cache ɒu
+// LOCALAPPDATA Ύst@C̗
+std::string cache_directory(){
+    char path[MAX_PATH];
+    DWORD n = GetEnvironmentVariableA("LOCALAPPDATA", path, sizeof(path));
+    if(n > 0 && n < sizeof(path)){
+        return std::string(path) + "\\clover\\cache";
+    }
+    n = GetModuleFileNameA(NULL, path, sizeof(path));
+    std::string exe(path, n < sizeof(path) ? n : 0);
+    return exe.substr(0, exe.find_last_of('\\') + 1) + "cache";
+}
+
 //-------- WinMain
 int WINAPI WinMain(HINSTANCE handle, HINSTANCE prev_handle, LPSTR lp_cmd, int n_cmd_show){
-    for(int i = 0; i < object::spectrum_cache_num; ++i){
-        object::spectrum_cache[0][i].reset(new float[256]{ 0.0 });
-        object::spectrum_cache[1][i].reset(new float[256]{ 0.0 });
-    }
+    // fR[hςPCMLbV (512MB)
+    PcmCache::configure(cache_directory(), 512ll * 1024 * 1024);
+
+    // I[fBĨXbh̓Xg[JĂ, Q[̃Xbh͂Őݒ肷
+    configure_threads(lp_cmd);
+    thread_config::apply(thread_config::role::game);
+    configure_memory(lp_cmd);
+    configure_stats(lp_cmd);
 
     // init PortAudio
     if(Pa_Initialize() != paNoError){
         return -1;
     }
 
+    // init mixer
+    if(!clover_system::audio.open(std::unique_ptr<audio_output::backend>(new audio_output::portaudio_output()), buffer_length)){
+        Pa_Terminate();
+        return -1;
+    }
+
     // load sound
-    sound_effect::hit.reset(new AudioDecoder("d/hit.mp3"));
-    if(sound_effect::hit->open() != 0){
+    if(!sound_effect::hit.load("d/hit.mp3", clover_system::audio.rate())){
+        clover_system::audio.close();
+        Pa_Terminate();
         return -1;
     }
 
@@ -1602,18 +1777,21 @@ int WINAPI WinMain(HINSTANCE handle, HINSTANCE prev_handle, LPSTR lp_cmd, int n_
     // init Draw
     SetTransColor(0xFF, 0, 0xFF);
     pattern::load_graphic();
+    object::colors::load();
     main_graphic_handle = MakeScreen(screen_width, screen_height);
 
     // scoped guard
     struct scoped_guard_type{
         ~scoped_guard_type(){
-            Pa_CloseStream(sound_effect::hit_stream);
+            shutdown_sound();
+            clover_system::audio.close();
+            clover_system::job_scheduler.reset();
             DxLib_End();
             Pa_Terminate();
         }
     } scoped_guard;
 
-    clover_system::current_loop.reset(new scene::title());
+    clover_system::change_scene<scene::title>();
     
     // main loop
     while(clover_system::current_loop->update()){
@@ -1621,6 +1799,11 @@ int WINAPI WinMain(HINSTANCE handle, HINSTANCE prev_handle, LPSTR lp_cmd, int n_
             i();
         }
         clover_system::action_queue.clear();
+
+        if(take_playback_failure()){
+            clover_system::on_dd = false;
+            clover_system::change_scene<scene::title>();
+        }
     }
 
     return 0;
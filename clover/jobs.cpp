@@ -0,0 +1,114 @@
+#include "jobs.hpp"
+
+namespace jobs{
+    static thread_local std::size_t current_partition = 0;
+
+    std::size_t partition(){
+        return current_partition;
+    }
+
+    scheduler::scheduler(int threads) : remaining_(0){
+        const std::size_t n = threads > 0 ? static_cast<std::size_t>(threads) : 0;
+        queue_num_ = n + 1;
+        queues_.reset(new queue[queue_num_]);
+        for(std::size_t i = 0; i < n; ++i){
+            threads_.emplace_back(&scheduler::worker, this, i + 1);
+        }
+    }
+
+    scheduler::~scheduler(){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        cv_.notify_all();
+        for(auto &t : threads_){
+            t.join();
+        }
+    }
+
+    void scheduler::run(std::size_t count, job_fn fn, void *ctx){
+        if(count == 0){
+            return;
+        }
+        if(threads_.empty() || count == 1){
+            for(std::size_t k = 0; k < count; ++k){
+                current_partition = k;
+                fn(ctx, k);
+            }
+            current_partition = 0;
+            return;
+        }
+
+        fn_ = fn;
+        ctx_ = ctx;
+        remaining_.store(count, std::memory_order_relaxed);
+
+        // ԍ̎Ⴂ珇ɃL[֔z
+        for(std::size_t k = 0; k < count; ++k){
+            queue &q = queues_[k % queue_num_];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.items.push_back(k);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++generation_;
+        }
+        cv_.notify_all();
+
+        work(0);
+        // ܂đ̃Xbhŏ̕҂
+        while(remaining_.load(std::memory_order_acquire) > 0){
+            std::this_thread::yield();
+        }
+    }
+
+    void scheduler::work(std::size_t self){
+        std::size_t k;
+        while(pop(self, k)){
+            current_partition = k;
+            fn_(ctx_, k);
+            current_partition = 0;
+            remaining_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    bool scheduler::pop(std::size_t self, std::size_t &k){
+        // ̃L[͌납
+        {
+            queue &q = queues_[self];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if(!q.items.empty()){
+                k = q.items.back();
+                q.items.pop_back();
+                return true;
+            }
+        }
+        // ̃L[͑O瓐
+        for(std::size_t i = 1; i < queue_num_; ++i){
+            queue &q = queues_[(self + i) % queue_num_];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if(!q.items.empty()){
+                k = q.items.front();
+                q.items.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void scheduler::worker(std::size_t self){
+        unsigned seen = 0;
+        for(;;){
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [&](){ return quit_ || generation_ != seen; });
+                if(quit_){
+                    return;
+                }
+                seen = generation_;
+            }
+            work(self);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <condition_variable>
+
+//-------- Wu
+// [J[ƂɋԂ̔ԍ̃L[, ̃L[ɂȂ瑼̃L[̐擪瓐
+// parallel_for Ă񂾃Xbhꏏɏ, SI܂Ŗ߂Ȃ
+//
+// Ԃ͗̕vfƗxŌ܂, Xbhⓐ܂ɂ͂Ȃ
+// ԂƂɌʂʁXɗ߂ĔԍɂȂ, Xbhŉ񂵂ĂʂɂȂ
+namespace jobs{
+    // 1 parallel_for 𕪂ő̐
+    const std::size_t max_partitions = 64;
+
+    // ̃XbhĂԂ̔ԍ (parallel_for ̊Oł 0)
+    std::size_t partition();
+
+    // vf n  1 grain ȏŕƂ̋Ԃ̐ (1  max_partitions)
+    inline std::size_t partitions(std::size_t n, std::size_t grain){
+        std::size_t p = grain > 0 ? n / grain : n;
+        return p < 1 ? 1 : p > max_partitions ? max_partitions : p;
+    }
+
+    class scheduler{
+    public:
+        // threads {̃[J[𗧂Ă (0 ȂSČĂ񂾃Xbhŏ)
+        explicit scheduler(int threads);
+        ~scheduler();
+
+        scheduler(const scheduler&) = delete;
+        scheduler &operator =(const scheduler&) = delete;
+
+        //  0  count - 1  fn(k) ŏ
+        // ɌĂׂ̂1̃Xbh炾 (qɂłȂ)
+        template<class F>
+        void parallel_for(std::size_t count, F fn){
+            run(count, [](void *f, std::size_t k){ (*static_cast<F*>(f))(k); }, &fn);
+        }
+
+        // [J[̐ (Ă񂾃Xbh͊܂܂Ȃ)
+        int thread_num() const{
+            return static_cast<int>(threads_.size());
+        }
+
+    private:
+        using job_fn = void (*)(void *ctx, std::size_t k);
+
+        struct queue{
+            std::mutex mutex;
+            std::deque<std::size_t> items;
+        };
+
+        void run(std::size_t count, job_fn fn, void *ctx);
+        void work(std::size_t self);
+        bool pop(std::size_t self, std::size_t &k);
+        void worker(std::size_t self);
+
+        std::vector<std::thread> threads_;
+
+        // 0 ͌Ă񂾃Xbh̕
+        std::unique_ptr<queue[]> queues_;
+        std::size_t queue_num_;
+
+        job_fn fn_ = nullptr;
+        void *ctx_ = nullptr;
+        std::atomic<std::size_t> remaining_;
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        unsigned generation_ = 0;
+        bool quit_ = false;
+    };
+}
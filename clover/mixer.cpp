@@ -0,0 +1,309 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <xmmintrin.h>
+#include "audiodecoder.h"
+#include "resampler.hpp"
+#include "mixer.hpp"
+#include "thread_config.hpp"
+
+namespace mixer{
+    //-------- clip
+    bool clip::load(const std::string &path, double rate){
+        std::unique_ptr<AudioDecoder> decoder(new AudioDecoder(path));
+        if(decoder->open() != AUDIODECODER_OK || decoder->channels() <= 0){
+            return false;
+        }
+        const int src_channels = decoder->channels();
+
+        // SǂŃXeIɂ
+        std::vector<sample_t> source;
+        std::vector<sample_t> block(AudioDecoderBase::kBlockSamples);
+        const int block_frames = AudioDecoderBase::kBlockSamples / src_channels;
+        for(;;){
+            int n = static_cast<int>(decoder->readFrames(block.data(), block_frames));
+            for(int i = 0; i < n; ++i){
+                for(int ch = 0; ch < channels; ++ch){
+                    source.push_back(block[i * src_channels + std::min(ch, src_channels - 1)]);
+                }
+            }
+            if(n < block_frames){
+                break;
+            }
+        }
+
+        if(static_cast<int>(rate) == decoder->sampleRate()){
+            samples_.swap(source);
+        }else{
+            resampler::polyphase r(channels, decoder->sampleRate(), rate);
+            std::size_t read_pos = 0;
+            samples_.clear();
+            std::vector<sample_t> out(block_frames * channels);
+            for(;;){
+                int n = r.pull(out.data(), block_frames, [&](sample_t *buffer, int frames){
+                    int m = static_cast<int>(std::min<std::size_t>(frames, (source.size() - read_pos) / channels));
+                    std::memcpy(buffer, source.data() + read_pos, m * channels * sizeof(sample_t));
+                    read_pos += m * channels;
+                    return m;
+                });
+                samples_.insert(samples_.end(), out.begin(), out.begin() + n * channels);
+                if(n < block_frames){
+                    break;
+                }
+            }
+        }
+        frames_ = static_cast<int>(samples_.size() / channels);
+        return frames_ > 0;
+    }
+
+    //-------- engine
+    engine::engine() : music_sent_(0), music_applied_(0), reset_requested_(true), music_buffer_(max_block * channels){
+        for(auto &v : voices_){
+            v.c = nullptr;
+        }
+        // vl̓R[obNŏ 0 ɂ
+        for(auto &h : histogram_){
+            h = 0;
+        }
+        callbacks_ = underflows_ = overflows_ = 0;
+        max_load_ = last_seconds_ = last_music_seconds_ = 0.0;
+        last_frames_ = 0;
+    }
+
+    engine::~engine(){
+        close();
+    }
+
+    bool engine::open(std::unique_ptr<audio_output::backend> output, unsigned long frames_per_buffer){
+        close();
+        thread_applied_ = false;
+        if(!output || !output->open(channels, frames_per_buffer, process, this)){
+            return false;
+        }
+        output_ = std::move(output);
+        rate_ = output_->rate();
+        return true;
+    }
+
+    void engine::close(){
+        if(output_){
+            output_->close();
+            output_.reset();
+        }
+    }
+
+    double engine::time() const{
+        return output_ ? output_->time() : 0.0;
+    }
+
+    double engine::latency() const{
+        return output_ ? output_->latency() : 0.0;
+    }
+
+    callback_stats engine::stats() const{
+        callback_stats s;
+        for(int i = 0; i < callback_stats::load_bins; ++i){
+            s.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+        }
+        s.callbacks = callbacks_.load(std::memory_order_relaxed);
+        s.underflows = underflows_.load(std::memory_order_relaxed);
+        s.overflows = overflows_.load(std::memory_order_relaxed);
+        s.max_load = max_load_.load(std::memory_order_relaxed);
+        s.last_frames = last_frames_.load(std::memory_order_relaxed);
+        s.last_seconds = last_seconds_.load(std::memory_order_relaxed);
+        s.last_music_seconds = last_music_seconds_.load(std::memory_order_relaxed);
+        s.cpu_load = output_ ? output_->cpu_load() : 0.0;
+        return s;
+    }
+
+    void engine::reset_stats(){
+        reset_requested_ = true;
+    }
+
+    void engine::record(int frames, double seconds, unsigned status){
+        // ̂̓R[obNȂ̂œǂŏ΂悢
+        if(reset_requested_.exchange(false, std::memory_order_relaxed)){
+            for(auto &h : histogram_){
+                h.store(0, std::memory_order_relaxed);
+            }
+            callbacks_.store(0, std::memory_order_relaxed);
+            underflows_.store(0, std::memory_order_relaxed);
+            overflows_.store(0, std::memory_order_relaxed);
+            max_load_.store(0.0, std::memory_order_relaxed);
+        }
+
+        const double load = frames > 0 ? seconds * rate_ / frames : 0.0;
+        int bin = static_cast<int>(load * (callback_stats::load_bins - 1));
+        bin = std::max(0, std::min(bin, callback_stats::load_bins - 1));
+        histogram_[bin].store(histogram_[bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        callbacks_.store(callbacks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if(status & audio_output::status_underflow){
+            underflows_.store(underflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        if(status & audio_output::status_overflow){
+            overflows_.store(overflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        if(load > max_load_.load(std::memory_order_relaxed)){
+            max_load_.store(load, std::memory_order_relaxed);
+        }
+        last_frames_.store(frames, std::memory_order_relaxed);
+        last_seconds_.store(seconds, std::memory_order_relaxed);
+        last_music_seconds_.store(music_seconds_, std::memory_order_relaxed);
+    }
+
+    bool engine::play(const clip &c, float gain, float pan){
+        // p[̃p
+        float angle = (std::max(-1.0f, std::min(1.0f, pan)) + 1.0f) * static_cast<float>(M_PI / 4);
+        command cmd;
+        cmd.type = command::kind::play;
+        cmd.c = &c;
+        cmd.gain_l = gain * std::cos(angle);
+        cmd.gain_r = gain * std::sin(angle);
+        return commands_.push(cmd);
+    }
+
+    bool engine::stop_all(){
+        command cmd;
+        cmd.type = command::kind::stop_all;
+        return commands_.push(cmd);
+    }
+
+    void engine::set_music(render_fn fn, void *user, float gain){
+        command cmd;
+        cmd.type = command::kind::music;
+        cmd.fn = fn;
+        cmd.user = user;
+        cmd.gain_l = cmd.gain_r = gain;
+        if(!output_ || !output_->active()){
+            // R[obNĂȂ̂Œڍւ
+            apply(cmd);
+            return;
+        }
+
+        using namespace std::literals;
+        while(!music_commands_.push(cmd)){
+            std::this_thread::sleep_for(1ms);
+        }
+        unsigned sent = ++music_sent_;
+        while(static_cast<int>(music_applied_.load() - sent) < 0 && output_->active()){
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    void engine::apply(const command &c){
+        switch(c.type){
+        case command::kind::play:
+            {
+                // 󂫂ΈԒĂ鐺D
+                voice *target = &voices_[0];
+                for(auto &v : voices_){
+                    if(!v.c){
+                        target = &v;
+                        break;
+                    }
+                    if(v.pos > target->pos){
+                        target = &v;
+                    }
+                }
+                target->c = c.c;
+                target->pos = 0;
+                target->gain_l = c.gain_l;
+                target->gain_r = c.gain_r;
+            }
+            break;
+
+        case command::kind::stop_all:
+            for(auto &v : voices_){
+                v.c = nullptr;
+            }
+            break;
+
+        case command::kind::music:
+            music_fn_ = c.fn;
+            music_user_ = c.user;
+            music_gain_ = c.gain_l;
+            break;
+        }
+    }
+
+    void engine::process(sample_t *out, int frames, double dac_time, unsigned status, void *user){
+        using clock = std::chrono::steady_clock;
+        const clock::time_point begin = clock::now();
+        const int frame_count = frames;
+        engine *e = static_cast<engine*>(user);
+        e->music_seconds_ = 0.0;
+
+        // R[obÑXbh͏o͐悪̂, ŏɌĂ΂ꂽƂɗDxグ
+        // (bN̊mۂȂg)
+        if(!e->thread_applied_){
+            thread_config::apply_current_thread(thread_config::role::audio);
+            e->thread_applied_ = true;
+        }
+        command cmd;
+        unsigned applied = 0;
+        while(e->music_commands_.pop(cmd)){
+            e->apply(cmd);
+            ++applied;
+        }
+        if(applied > 0){
+            e->music_applied_ += applied;
+        }
+        while(e->commands_.pop(cmd)){
+            e->apply(cmd);
+        }
+
+        while(frames > 0){
+            int n = std::min(frames, static_cast<int>(max_block));
+            e->render(out, n, dac_time);
+            out += n * channels;
+            frames -= n;
+            dac_time += n / e->rate_;
+        }
+
+        e->record(frame_count, std::chrono::duration<double>(clock::now() - begin).count(), status);
+    }
+
+    // (l, r, l, r) ̌W|đ
+    static void mix_stereo(sample_t *out, const sample_t *in, int frames, float gain_l, float gain_r){
+        const __m128 g = _mm_setr_ps(gain_l, gain_r, gain_l, gain_r);
+        int i = 0;
+        for(; i + 2 <= frames; i += 2){
+            __m128 a = _mm_loadu_ps(out + i * channels);
+            __m128 b = _mm_loadu_ps(in + i * channels);
+            _mm_storeu_ps(out + i * channels, _mm_add_ps(a, _mm_mul_ps(b, g)));
+        }
+        for(; i < frames; ++i){
+            out[i * channels + 0] += in[i * channels + 0] * gain_l;
+            out[i * channels + 1] += in[i * channels + 1] * gain_r;
+        }
+    }
+
+    void engine::render(sample_t *out, int frames, double dac_time){
+        std::memset(out, 0, frames * channels * sizeof(sample_t));
+
+        if(music_fn_){
+            sample_t *music = music_buffer_.data();
+            std::memset(music, 0, frames * channels * sizeof(sample_t));
+            const auto begin = std::chrono::steady_clock::now();
+            music_fn_(music, frames, dac_time, music_user_);
+            music_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            mix_stereo(out, music, frames, music_gain_, music_gain_);
+        }
+
+        for(auto &v : voices_){
+            if(!v.c){
+                continue;
+            }
+            int n = std::min(frames, v.c->frames() - v.pos);
+            mix_stereo(out, v.c->data() + v.pos * channels, n, v.gain_l, v.gain_r);
+            v.pos += n;
+            if(v.pos >= v.c->frames()){
+                v.c = nullptr;
+            }
+        }
+    }
+}
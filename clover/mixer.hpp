@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include "spsc_ring.hpp"
+#include "audio_output.hpp"
+
+//-------- ~LT[
+// o̓Xg[1{J, yƌʉR[obN̒ō
+// Q[Xbh̑̓bNt[̃L[ɐςނŃubNȂ
+namespace mixer{
+    using sample_t = float;
+
+    // o͂̃`l (XeIŒ)
+    const int channels = 2;
+
+    // ɓWJʉ
+    // XeI/o͂̃Tv[gɕϊĎ
+    class clip{
+    public:
+        // path fR[h rate ɍ킹Ă
+        bool load(const std::string &path, double rate);
+
+        const sample_t *data() const{
+            return samples_.data();
+        }
+
+        int frames() const{
+            return frames_;
+        }
+
+    private:
+        std::vector<sample_t> samples_;
+        int frames_ = 0;
+    };
+
+    // y𗬂ރR[obN
+    // out (XeI, ŏς)  frames t[
+    // dac_time  out ̐擪̃t[DACo鎞 (engine::time Ɠv)
+    using render_fn = void (*)(sample_t *out, int frames, double dac_time, void *user);
+
+    // I[fBIR[obŇv
+    struct callback_stats{
+        //  / ߐ؂ (obt@̎) ̕z
+        // i Ԗ (i < load_bins - 1)  i * 10% ȏ (i + 1) * 10% , Ō͒ߐ؂𒴂
+        static const int load_bins = 11;
+        unsigned long long histogram[load_bins];
+
+        unsigned long long callbacks;
+
+        // o͐悪񍐂؂/肱ڂ
+        unsigned long long underflows, overflows;
+
+        //  / ߐ؂̍ől
+        double max_load;
+
+        // ߂̃R[obÑt[Ə (b)
+        int last_frames;
+        double last_seconds;
+
+        // ߂̂ỹR[obNɂ (b)
+        double last_music_seconds;
+
+        // o͐悪񍐂CPU (snapshot Ă񂾎_̒l)
+        double cpu_load;
+    };
+
+    class engine{
+    public:
+        // ɖ点ʉ̐
+        static const int voice_num = 32;
+
+        engine();
+        ~engine();
+
+        // output JĖ炵n߂
+        // frames_per_buffer  audio_output::frames_unspecified Ȃobt@͏o͐ɔC
+        bool open(std::unique_ptr<audio_output::backend> output, unsigned long frames_per_buffer);
+        void close();
+
+        // Xg[̃Tv[g
+        double rate() const{
+            return rate_;
+        }
+
+        // I[fBI̎v (b, P)
+        // Xs[J[oĂ鉹 dac_time ȉ̂
+        double time() const;
+
+        // Ă畷܂ł̒x (b)
+        double latency() const;
+
+        //-------- ȉ̓Q[XbhĂ (ubNȂ)
+        // ʉ炷
+        // pan  -1 ()  +1 (E). L[tȂ false
+        bool play(const clip &c, float gain = 1.0f, float pan = 0.0f);
+
+        // ĂʉSĎ~߂
+        bool stop_all();
+
+        // vʂǂ (ǂ̃Xbhł悢. ubNȂ)
+        callback_stats stats() const;
+
+        // vʂ 0 ɖ߂ (̃R[obNŔf)
+        void reset_stats();
+
+        //-------- ȉ͉yǗXbhĂ
+        // ỹR[obNւ
+        // R[obNւ󂯎܂ő҂̂, ߂͌ÂR[obN͌Ă΂Ȃ
+        void set_music(render_fn fn, void *user, float gain = 1.0f);
+
+    private:
+        struct command{
+            enum class kind{
+                play,
+                stop_all,
+                music
+            } type;
+            const clip *c;
+            float gain_l, gain_r;
+            render_fn fn;
+            void *user;
+        };
+
+        struct voice{
+            const clip *c;
+            int pos;
+            float gain_l, gain_r;
+        };
+
+        // o͐悩Ă΂
+        static void process(sample_t *out, int frames, double dac_time, unsigned status, void *user);
+
+        void render(sample_t *out, int frames, double dac_time);
+        void record(int frames, double seconds, unsigned status);
+        void apply(const command &c);
+
+        // 1̕`݂ňőt[
+        static const int max_block = 4096;
+
+        std::unique_ptr<audio_output::backend> output_;
+        double rate_ = 0.0;
+
+        // Q[Xbh -> R[obN
+        spsc_ring<command, 256> commands_;
+
+        // yXbh -> R[obN
+        spsc_ring<command, 8> music_commands_;
+        std::atomic<unsigned> music_sent_, music_applied_;
+
+        // v (̂̓R[obN)
+        std::atomic<unsigned long long> histogram_[callback_stats::load_bins];
+        std::atomic<unsigned long long> callbacks_, underflows_, overflows_;
+        std::atomic<double> max_load_, last_seconds_, last_music_seconds_;
+        std::atomic<int> last_frames_;
+        std::atomic<bool> reset_requested_;
+
+        // ȉ̓R[obNG
+        voice voices_[voice_num];
+        double music_seconds_ = 0.0;
+        bool thread_applied_ = false;
+        render_fn music_fn_ = nullptr;
+        void *music_user_ = nullptr;
+        float music_gain_ = 1.0f;
+        std::vector<sample_t> music_buffer_;
+    };
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <xmmintrin.h>
+#include "jobs.hpp"
+
+//-------- p[eBN̓ꕨ
+// vfƂɕʁX̔z (x, y, vx, vy, age, color) Ŏ,
+// ʒuƔN̍XV SSE 4܂Ƃ߂čs
+// ͑SēȂ̂, ɕׂĂΎ񂾂̂͏ɐ擪ɏW܂
+template<std::size_t N>
+class particle_store{
+    // SSE ł܂Ƃ߂ĉ񂷂߂4̔{ɐ؂グ
+    static const std::size_t capacity = (N + 3) & ~std::size_t(3);
+
+public:
+    // lifetime : Ă܂ł update ̉
+    explicit particle_store(int lifetime) : lifetime_(static_cast<float>(lifetime)){
+        // ̔[ȕꏏɌvẐŏĂ
+        for(float *a : { x_, y_, vx_, vy_, age_ }){
+            std::fill(a, a + capacity, 0.0f);
+        }
+    }
+
+    // 1. tȂ drops 𐔂 false
+    bool spawn(float x, float y, float vx, float vy, unsigned int color){
+        if(size_ == N){
+            ++drops_;
+            return false;
+        }
+        x_[size_] = x;
+        y_[size_] = y;
+        vx_[size_] = vx;
+        vy_[size_] = vy;
+        age_[size_] = 0.0f;
+        color_[size_] = color;
+        ++size_;
+        ++spawned_;
+        high_water_ = std::max(high_water_, size_);
+        return true;
+    }
+
+    // SĂ1t[ĔN点, ̐ŝl߂
+    void update(){
+        integrate(0, size_);
+        compact();
+    }
+
+    // Ƃ 1 grain ȏɕ jobs ŕɍs (l߂̂͌Ă񂾃Xbh)
+    void update(jobs::scheduler &s, std::size_t grain){
+        const std::size_t parts = jobs::partitions(size_, grain);
+        if(parts <= 1){
+            update();
+            return;
+        }
+        // Ԃ̋ڂ4̔{ɑ
+        const std::size_t step = ((size_ + parts - 1) / parts + 3) & ~std::size_t(3);
+        s.parallel_for(parts, [&](std::size_t k){
+            integrate(std::min(size_, k * step), std::min(size_, (k + 1) * step));
+        });
+        compact();
+    }
+
+    void clear(){
+        size_ = 0;
+    }
+
+    std::size_t size() const{
+        return size_;
+    }
+
+    bool empty() const{
+        return size_ == 0;
+    }
+
+    bool full() const{
+        return size_ == N;
+    }
+
+    // 鐔
+    std::size_t max_size() const{
+        return N;
+    }
+
+    // size ̍ől
+    std::size_t high_water() const{
+        return high_water_;
+    }
+
+    // 
+    std::size_t spawned() const{
+        return spawned_;
+    }
+
+    // tŐłȂ
+    std::size_t drops() const{
+        return drops_;
+    }
+
+    // high_water ̐, spawned  drops  0 ɖ߂
+    void reset_stats(){
+        high_water_ = size_;
+        spawned_ = drops_ = 0;
+    }
+
+    float x(std::size_t i) const{
+        return x_[i];
+    }
+
+    float y(std::size_t i) const{
+        return y_[i];
+    }
+
+    float vx(std::size_t i) const{
+        return vx_[i];
+    }
+
+    float vy(std::size_t i) const{
+        return vy_[i];
+    }
+
+    int age(std::size_t i) const{
+        return static_cast<int>(age_[i]);
+    }
+
+    unsigned int color(std::size_t i) const{
+        return color_[i];
+    }
+
+private:
+    // [first, last) 𓮂. first 4̔{
+    void integrate(std::size_t first, std::size_t last){
+        const __m128 one = _mm_set1_ps(1.0f);
+        for(std::size_t i = first; i < last; i += 4){
+            _mm_store_ps(x_ + i, _mm_add_ps(_mm_load_ps(x_ + i), _mm_load_ps(vx_ + i)));
+            _mm_store_ps(y_ + i, _mm_add_ps(_mm_load_ps(y_ + i), _mm_load_ps(vy_ + i)));
+            _mm_store_ps(age_ + i, _mm_add_ps(_mm_load_ps(age_ + i), one));
+        }
+    }
+
+    // ̐ŝ菜ċl߂ (Ԃ͕ۂ)
+    void compact(){
+        std::size_t w = 0;
+        while(w < size_ && age_[w] < lifetime_){
+            ++w;
+        }
+        for(std::size_t r = w; r < size_; ++r){
+            if(age_[r] >= lifetime_){
+                continue;
+            }
+            x_[w] = x_[r];
+            y_[w] = y_[r];
+            vx_[w] = vx_[r];
+            vy_[w] = vy_[r];
+            age_[w] = age_[r];
+            color_[w] = color_[r];
+            ++w;
+        }
+        size_ = w;
+    }
+
+    float lifetime_;
+    std::size_t size_ = 0, high_water_ = 0, spawned_ = 0, drops_ = 0;
+    alignas(16) float x_[capacity];
+    alignas(16) float y_[capacity];
+    alignas(16) float vx_[capacity];
+    alignas(16) float vy_[capacity];
+    alignas(16) float age_[capacity];
+    unsigned int color_[capacity];
+};
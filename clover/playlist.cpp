@@ -0,0 +1,261 @@
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include "playlist.hpp"
+#include "thread_config.hpp"
+
+namespace playlist{
+    // ɃfR[hĂȂ̓̒ (b)
+    static const double head_seconds = 0.5;
+
+    track::track(const std::string &path) : path_(path), decoder_(new AudioDecoder(path)){}
+
+    track::~track() = default;
+
+    bool track::open(){
+        return decoder_->open() == AUDIODECODER_OK;
+    }
+
+    int track::source_channels() const{
+        return decoder_->channels();
+    }
+
+    void track::prepare(int stream_channels, double stream_rate, resampler::quality q, int head_frames){
+        channels_ = stream_channels;
+        if(static_cast<int>(stream_rate) != decoder_->sampleRate()){
+            resampler_.reset(new resampler::polyphase(channels_, decoder_->sampleRate(), stream_rate, q));
+        }
+        length_ = static_cast<long long>(decoder_->numSamples() / decoder_->channels() * (stream_rate / decoder_->sampleRate()));
+
+        head_.resize(head_frames * channels_);
+        int n = read_converted(head_.data(), head_frames);
+        head_.resize(n * channels_);
+        head_pos_ = 0;
+
+        analysis_.load(path_, static_cast<int>(stream_rate));
+    }
+
+    int track::read(sample_t *out, int frames){
+        int done = 0;
+        if(head_pos_ < head_.size()){
+            int n = std::min(frames, static_cast<int>((head_.size() - head_pos_) / channels_));
+            std::memcpy(out, &head_[head_pos_], n * channels_ * sizeof(sample_t));
+            head_pos_ += n * channels_;
+            done += n;
+        }
+        if(done < frames){
+            done += read_converted(out + done * channels_, frames - done);
+        }
+        return done;
+    }
+
+    int track::read_converted(sample_t *out, int frames){
+        if(resampler_){
+            return resampler_->pull(out, frames, [this](sample_t *buffer, int n){
+                return read_decoder(buffer, n);
+            });
+        }else{
+            return read_decoder(out, frames);
+        }
+    }
+
+    // fR[_ǂŃXg[̃`lɍ킹
+    int track::read_decoder(sample_t *out, int frames){
+        const int src_channels = decoder_->channels();
+        if(src_channels == channels_){
+            return static_cast<int>(decoder_->readFrames(out, frames));
+        }
+
+        // `lႤꍇ̓fR[_̃ubN؂Ēڕבւ
+        int done = 0;
+        while(done < frames){
+            const sample_t *block;
+            int got = static_cast<int>(decoder_->borrowBlock(&block, frames - done));
+            if(got == 0){
+                break;
+            }
+            for(int i = 0; i < got; ++i){
+                for(int ch = 0; ch < channels_; ++ch){
+                    out[(done + i) * channels_ + ch] = block[i * src_channels + std::min(ch, src_channels - 1)];
+                }
+            }
+            done += got;
+        }
+        return done;
+    }
+
+    engine::engine(int prefetch) : prefetch_(prefetch), idle_(true), next_(nullptr), position_(0), length_(0), ready_(false), failed_(false){}
+
+    engine::~engine(){
+        stop();
+    }
+
+    void engine::start(const std::vector<std::string> &paths, double stream_rate, resampler::quality q, int stream_channels){
+        stop();
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.assign(paths.begin(), paths.end());
+        rate_ = stream_rate;
+        quality_ = q;
+        channels_ = stream_channels;
+        source_channels_ = 0;
+        stopping_ = false;
+        idle_ = pending_.empty();
+        position_ = 0;
+        length_ = 0;
+        ready_ = false;
+        failed_ = false;
+        worker_ = std::thread([this](){ worker_main(); });
+    }
+
+    void engine::stop(){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cond_.notify_all();
+        if(worker_.joinable()){
+            worker_.join();
+        }
+    }
+
+    void engine::enqueue(const std::string &path){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(path);
+            idle_ = false;
+        }
+        cond_.notify_all();
+    }
+
+    bool engine::wait_ready(){
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this](){ return ready_ || failed_ || stopping_; });
+        return ready_;
+    }
+
+    engine::ready_state engine::wait_ready_for(std::chrono::milliseconds timeout){
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, timeout, [this](){ return ready_ || failed_ || stopping_; });
+        if(ready_){
+            return ready_state::ready;
+        }
+        return failed_ || stopping_ ? ready_state::failed : ready_state::waiting;
+    }
+
+    bool engine::finished() const{
+        return idle_ && current_ == nullptr && next_.load() == nullptr;
+    }
+
+    bool engine::cached_bands(long long start, int ch, float *band) const{
+        if(!current_ || start < 0){
+            return false;
+        }
+        // Xg[̃ubN̋؂͋Ȃ̐擪ƂĂȂ̂, ߂Ɋۂ߂
+        return current_->analysis().read((start + spectrum::block_hop / 2) / spectrum::block_hop, ch, band);
+    }
+
+    int engine::read(sample_t *out, int frames){
+        int done = 0;
+        while(done < frames){
+            if(!current_){
+                current_ = next_.exchange(nullptr);
+                if(!current_){
+                    break;
+                }
+                position_ = 0;
+                length_ = current_->length();
+            }
+            int n = current_->read(out + done * channels_, frames - done);
+            done += n;
+            position_ += n;
+            if(done < frames){
+                // Ȃ̏I. j̓[J[ɔCĎ̋Ȃő𖄂߂
+                // (OقǋȂZƂ͂Ȃ̂ push ̎s͍lȂ)
+                retired_.push(current_);
+                current_ = nullptr;
+            }
+        }
+        return done;
+    }
+
+    void engine::worker_main(){
+        using namespace std::literals;
+        thread_config::apply(thread_config::role::worker);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(!stopping_){
+            // gIȂj
+            track *t;
+            while(retired_.pop(t)){
+                lock.unlock();
+                delete t;
+                lock.lock();
+            }
+
+            // ̋ȂR[obNɓn
+            if(next_.load() == nullptr && !prepared_.empty()){
+                next_.store(prepared_.front());
+                prepared_.pop_front();
+                if(!ready_){
+                    ready_ = true;
+                    cond_.notify_all();
+                }
+            }
+
+            // ǂ
+            if(!pending_.empty() && static_cast<int>(prepared_.size()) < prefetch_){
+                std::string path = pending_.front();
+                pending_.pop_front();
+                lock.unlock();
+                std::unique_ptr<track> u(new track(path));
+                bool ok = u->open();
+                lock.lock();
+                if(stopping_){
+                    // JĂԂɎ~߂ꂽ瓪̃fR[h͂Ɏ̂Ă
+                    lock.unlock();
+                    u.reset();
+                    lock.lock();
+                    continue;
+                }
+                if(ok){
+                    if(source_channels_ == 0){
+                        source_channels_ = u->source_channels();
+                    }
+                    if(channels_ == 0){
+                        channels_ = u->source_channels();
+                    }
+                    int channels = channels_;
+                    lock.unlock();
+                    u->prepare(channels, rate_, quality_, static_cast<int>(rate_ * head_seconds));
+                    lock.lock();
+                    prepared_.push_back(u.release());
+                }
+                continue;
+            }
+
+            idle_ = pending_.empty() && prepared_.empty();
+            if(!ready_ && idle_ && next_.load() == nullptr){
+                failed_ = true;
+                cond_.notify_all();
+            }
+            cond_.wait_for(lock, 10ms);
+        }
+
+        // cĂȂSĔj
+        // Xg[͕Ă̂ōĐ̋ȂŔjĂ悢
+        lock.unlock();
+        track *t;
+        while(retired_.pop(t)){
+            delete t;
+        }
+        for(track *u : prepared_){
+            delete u;
+        }
+        prepared_.clear();
+        pending_.clear();
+        delete next_.exchange(nullptr);
+        delete current_;
+        current_ = nullptr;
+        idle_ = true;
+        cond_.notify_all();
+    }
+}
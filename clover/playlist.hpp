@@ -0,0 +1,176 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <condition_variable>
+#include "audiodecoder.h"
+#include "resampler.hpp"
+#include "spsc_ring.hpp"
+#include "spectrum.hpp"
+
+//-------- vCXg
+// ɖ炷Ȃ[J[XbhŐɊJēoĂ,
+// I[fBIR[obN̒ŋȂ̋ڂTvPʂŌpڂȂ؂ւ
+namespace playlist{
+    using sample_t = float;
+
+    // 1ȕ
+    // Xg[̃`l/Tv[gɍ킹ēǂݏo
+    class track{
+    public:
+        track(const std::string &path);
+        ~track();
+
+        // fR[_J ([J[XbhŌĂ)
+        bool open();
+
+        // Xg[̌`ɍ킹鏀ċȂ̓fR[hĂ
+        // Xg[̃Tv[gŉ͂LbVΓǂł
+        void prepare(int stream_channels, double stream_rate, resampler::quality q, int head_frames);
+
+        // ő frames t[ǂ
+        // frames ԂȂ̏I
+        int read(sample_t *out, int frames);
+
+        // fR[_̃`l
+        int source_channels() const;
+
+        // Xg[̃t[ŕ\Ȃ̒
+        long long length() const{
+            return length_;
+        }
+
+        const std::string &path() const{
+            return path_;
+        }
+
+        // tools/analyze ͌ ( loaded()  false)
+        const spectrum::cache &analysis() const{
+            return analysis_;
+        }
+
+    private:
+        int read_converted(sample_t *out, int frames);
+        int read_decoder(sample_t *out, int frames);
+
+        std::string path_;
+        std::unique_ptr<AudioDecoder> decoder_;
+        std::unique_ptr<resampler::polyphase> resampler_;
+        std::vector<sample_t> head_;
+        std::size_t head_pos_ = 0;
+        int channels_ = 0;
+        long long length_ = 0;
+        spectrum::cache analysis_;
+    };
+
+    class engine{
+    public:
+        // prefetch : ɊJĂȐ
+        engine(int prefetch = 2);
+        ~engine();
+
+        // Ȃ̃XgւĐǂ݂n߂
+        // stream_rate/stream_channels ͏o͂Tv[gƃ`l
+        // stream_channels  0 ȂŏɊJȂɍ킹
+        void start(const std::vector<std::string> &paths, double stream_rate, resampler::quality q, int stream_channels = 0);
+
+        // ǂ݂~߂đSĂ̋Ȃj
+        // [J[JĂr̋Ȃ͂ open I܂ő҂ (̃fR[h͂Ȃ)
+        // Xg[ĂĂԂ
+        void stop();
+
+        // Ȃ𖖔ɒǉ
+        void enqueue(const std::string &path);
+
+        // ŏ̋ȂJ܂ő҂
+        // 1ȂJȂ false
+        bool wait_ready();
+
+        enum class ready_state{
+            waiting,
+            ready,
+            failed
+        };
+
+        // ŏ̋ȂJ܂ timeout ҂
+        ready_state wait_ready_for(std::chrono::milliseconds timeout);
+
+        // o͂̃`l
+        int channels() const{
+            return channels_;
+        }
+
+        // ŏɊJȂ̃`l
+        int source_channels() const{
+            return source_channels_;
+        }
+
+        double rate() const{
+            return rate_;
+        }
+
+        //-------- ȉ̓I[fBIR[obNĂ
+        // frames t[ǂ. Ȃ̋ڂł͎̋Ȃɐ؂ւđ𖄂߂
+        // frames ԂĐ̂Ȃ
+        int read(sample_t *out, int frames);
+
+        // Đ̋Ȃ̈ʒuƒ (t[)
+        long long position() const{
+            return position_.load();
+        }
+
+        long long length() const{
+            return length_.load();
+        }
+
+        // SĂ̋Ȃ炵I
+        bool finished() const;
+
+        // Đ̋Ȃ͍̉ς݂̉ʂ band[spectrum::bands] ɏ
+        // start ͋Ȃ̐擪琔ubN̐擪̃t[. ԋ߂LbṼubNg
+        // LbV/͈͊OȂ false
+        bool cached_bands(long long start, int ch, float *band) const;
+
+    private:
+        void worker_main();
+
+        int prefetch_;
+        double rate_ = 0.0;
+        int channels_ = 0;
+        int source_channels_ = 0;
+        resampler::quality quality_ = resampler::quality::medium;
+
+        std::thread worker_;
+        mutable std::mutex mutex_;
+        std::condition_variable cond_;
+        bool stopping_ = false;
+
+        // JׂȂJȂcĂȂ
+        std::atomic<bool> idle_;
+
+        // ܂JĂȂ
+        std::deque<std::string> pending_;
+
+        // Jēo܂ōς񂾋
+        std::deque<track*> prepared_;
+
+        // R[obNɓn̋
+        std::atomic<track*> next_;
+
+        // R[obNgI ([J[j)
+        spsc_ring<track*, 16> retired_;
+
+        // Đ̋ (R[obNG)
+        track *current_ = nullptr;
+        std::atomic<long long> position_, length_;
+
+        // ҂킹p
+        std::atomic<bool> ready_, failed_;
+    };
+}
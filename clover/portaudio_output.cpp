@@ -0,0 +1,83 @@
+#include "portaudio_output.hpp"
+
+namespace audio_output{
+    portaudio_output::~portaudio_output(){
+        close();
+    }
+
+    bool portaudio_output::open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user){
+        close();
+        fn_ = fn;
+        user_ = user;
+        const PaDeviceInfo *device_info = Pa_GetDeviceInfo(Pa_GetDefaultOutputDevice());
+        rate_ = device_info && device_info->defaultSampleRate > 0.0 ? device_info->defaultSampleRate : 44100.0;
+        PaError err = Pa_OpenDefaultStream(
+            &stream_,
+            0,
+            channels,
+            paFloat32,
+            rate_,
+            frames_per_buffer,
+            callback,
+            this
+        );
+        if(err != paNoError){
+            stream_ = nullptr;
+            return false;
+        }
+        const PaStreamInfo *stream_info = Pa_GetStreamInfo(stream_);
+        latency_ = stream_info ? stream_info->outputLatency : 0.0;
+        if(Pa_StartStream(stream_) != paNoError){
+            Pa_CloseStream(stream_);
+            stream_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void portaudio_output::close(){
+        if(stream_){
+            Pa_StopStream(stream_);
+            Pa_CloseStream(stream_);
+            stream_ = nullptr;
+        }
+    }
+
+    bool portaudio_output::active() const{
+        return stream_ && Pa_IsStreamActive(stream_) == 1;
+    }
+
+    double portaudio_output::time() const{
+        return stream_ ? Pa_GetStreamTime(stream_) : 0.0;
+    }
+
+    double portaudio_output::cpu_load() const{
+        return stream_ ? Pa_GetStreamCpuLoad(stream_) : 0.0;
+    }
+
+    int portaudio_output::callback(
+        const void *input_buffer,
+        void *output_buffer,
+        unsigned long frame_count,
+        const PaStreamCallbackTimeInfo *time_info,
+        PaStreamCallbackFlags status_flags,
+        void *user_data
+    ){
+        portaudio_output *p = static_cast<portaudio_output*>(user_data);
+
+        // DACԂȂzXgAPIł͏o͂̒xꂩ猩ς
+        double dac_time = time_info ? time_info->outputBufferDacTime : 0.0;
+        if(dac_time <= 0.0){
+            dac_time = Pa_GetStreamTime(p->stream_) + p->latency_;
+        }
+        unsigned status = 0;
+        if(status_flags & paOutputUnderflow){
+            status |= status_underflow;
+        }
+        if(status_flags & paOutputOverflow){
+            status |= status_overflow;
+        }
+        p->fn_(static_cast<sample_t*>(output_buffer), static_cast<int>(frame_count), dac_time, status, p->user_);
+        return paContinue;
+    }
+}
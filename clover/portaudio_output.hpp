@@ -0,0 +1,45 @@
+#pragma once
+
+#include <portaudio.h>
+#include "audio_output.hpp"
+
+//-------- ̏o̓foCX (PortAudio)
+// Pa_Initialize ς܂ĂJ
+namespace audio_output{
+    class portaudio_output : public backend{
+    public:
+        ~portaudio_output();
+
+        bool open(int channels, unsigned long frames_per_buffer, process_fn fn, void *user) override;
+        void close() override;
+        bool active() const override;
+
+        double rate() const override{
+            return rate_;
+        }
+
+        double time() const override;
+
+        double latency() const override{
+            return latency_;
+        }
+
+        double cpu_load() const override;
+
+    private:
+        static int callback(
+            const void *input_buffer,
+            void *output_buffer,
+            unsigned long frame_count,
+            const PaStreamCallbackTimeInfo *time_info,
+            PaStreamCallbackFlags status_flags,
+            void *user_data
+        );
+
+        PaStream *stream_ = nullptr;
+        double rate_ = 0.0;
+        double latency_ = 0.0;
+        process_fn fn_ = nullptr;
+        void *user_ = nullptr;
+    };
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <xmmintrin.h>
+
+//-------- |tF[Y֐tsincTv
+// fR[_̃Tv[gƃfoCX̃Tv[gقȂꍇ
+// fR[_ƃXg[̊ԂɋŎg
+namespace resampler{
+    // ivZbg
+    enum class quality : int{
+        low,
+        medium,
+        high
+    };
+
+    struct preset{
+        // 1tF[Ỹ^bv (4̔{)
+        int taps;
+        // tF[Y
+        int phases;
+        // JbgIt (iCLXgg)
+        float rolloff;
+        // Kaiser̃
+        float beta;
+    };
+
+    inline preset get_preset(quality q){
+        switch(q){
+        case quality::low:
+            return preset{ 16, 64, 0.85f, 6.0f };
+
+        case quality::high:
+            return preset{ 64, 256, 0.945f, 10.0f };
+
+        case quality::medium:
+        default:
+            return preset{ 32, 128, 0.9f, 8.0f };
+        }
+    }
+
+    // 1ό`xbZ֐ I0
+    inline double bessel_i0(double x){
+        double sum = 1.0, term = 1.0;
+        for(int k = 1; k < 64; ++k){
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if(term < sum * 1e-12){
+                break;
+            }
+        }
+        return sum;
+    }
+
+    class polyphase{
+    public:
+        // 1̓ǂݍ݂ŗv̓t[
+        static const int chunk_frames = 256;
+
+        polyphase(int channels, double in_rate, double out_rate, quality q = quality::medium) :
+            channels_(channels),
+            step_(in_rate / out_rate),
+            preset_(get_preset(q)),
+            table_((preset_.phases + 1) * preset_.taps),
+            history_(channels),
+            scratch_(chunk_frames * channels)
+        {
+            // tB^e[u쐬
+            // table_[p * taps + k] ͓͈ʒȕ p / phases ̂Ƃ k Ԗڂ̃^bv
+            const int taps = preset_.taps, phases = preset_.phases;
+            const double cutoff = std::min(1.0, out_rate / in_rate) * preset_.rolloff;
+            const double half = taps / 2;
+            const double i0_beta = bessel_i0(preset_.beta);
+            for(int p = 0; p <= phases; ++p){
+                double frac = static_cast<double>(p) / phases;
+                for(int k = 0; k < taps; ++k){
+                    double d = k - half + 1 - frac;
+                    double x = 3.14159265358979323846 * cutoff * d;
+                    double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(x) / x;
+                    double r = d / half;
+                    double w = std::abs(r) >= 1.0 ? 0.0 : bessel_i0(preset_.beta * std::sqrt(1.0 - r * r)) / i0_beta;
+                    table_[p * taps + k] = static_cast<float>(cutoff * sinc * w);
+                }
+            }
+
+            for(auto &h : history_){
+                h.resize(taps + chunk_frames);
+            }
+            reset();
+        }
+
+        // Ԃ
+        void reset(){
+            for(auto &h : history_){
+                std::fill(h.begin(), h.end(), 0.0f);
+            }
+            // ŏ̏o͂͂0t[ڂɑ悤ɐ擪𖳉Ŗ߂Ă
+            count_ = preset_.taps / 2 - 1;
+            pos_ = count_;
+            flushed_ = false;
+        }
+
+        //  1 t[̏o̓t[
+        double ratio() const{
+            return 1.0 / step_;
+        }
+
+        // out  frames t[C^[[uŏo͂
+        // read(float *interleaved, int frames) ͓ǂݍ񂾃t[Ԃ
+        // ߂l͏o͂t[ (͂sframesɂȂ)
+        template<class Read>
+        int pull(float *out, int frames, Read read){
+            const int taps = preset_.taps, half = taps / 2;
+            int produced = 0;
+            while(produced < frames){
+                int i = static_cast<int>(pos_);
+                if(i + half >= count_){
+                    if(!refill(read)){
+                        break;
+                    }
+                    continue;
+                }
+
+                float p = static_cast<float>((pos_ - i) * preset_.phases);
+                int pi = static_cast<int>(p);
+                float pf = p - pi;
+                const float *c0 = &table_[pi * taps], *c1 = c0 + taps;
+                for(int ch = 0; ch < channels_; ++ch){
+                    out[produced * channels_ + ch] = dot(&history_[ch][i - half + 1], c0, c1, pf, taps);
+                }
+                pos_ += step_;
+                ++produced;
+            }
+            return produced;
+        }
+
+    private:
+        // 2̗אڃtF[Y`ԂWƗ̓
+        static float dot(const float *x, const float *c0, const float *c1, float f, int taps){
+            __m128 acc = _mm_setzero_ps();
+            const __m128 vf = _mm_set1_ps(f);
+            for(int k = 0; k < taps; k += 4){
+                __m128 a = _mm_loadu_ps(c0 + k);
+                __m128 b = _mm_loadu_ps(c1 + k);
+                __m128 c = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), vf));
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + k), c));
+            }
+            acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+            acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+            return _mm_cvtss_f32(acc);
+        }
+
+        // gÎĂē͂ǂݑ
+        template<class Read>
+        bool refill(Read &read){
+            const int half = preset_.taps / 2;
+            int drop = std::max(0, static_cast<int>(pos_) - (half - 1));
+            drop = std::min(drop, count_);
+            if(drop > 0){
+                for(auto &h : history_){
+                    std::copy(h.begin() + drop, h.begin() + count_, h.begin());
+                }
+                count_ -= drop;
+                pos_ -= drop;
+            }
+
+            int space = static_cast<int>(history_[0].size()) - count_;
+            int n = flushed_ ? 0 : read(scratch_.data(), std::min(space, static_cast<int>(chunk_frames)));
+            if(n <= 0){
+                // ͂stB^̌㔼𗬂Ďco؂
+                if(flushed_){
+                    return false;
+                }
+                flushed_ = true;
+                n = std::min(space, half);
+                std::fill(scratch_.begin(), scratch_.begin() + n * channels_, 0.0f);
+            }
+            for(int ch = 0; ch < channels_; ++ch){
+                float *h = &history_[ch][count_];
+                for(int j = 0; j < n; ++j){
+                    h[j] = scratch_[j * channels_ + ch];
+                }
+            }
+            count_ += n;
+            return true;
+        }
+
+        int channels_;
+        double step_;
+        preset preset_;
+        std::vector<float> table_;
+        std::vector<std::vector<float>> history_;
+        std::vector<float> scratch_;
+        int count_;
+        double pos_;
+        bool flushed_;
+    };
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <emmintrin.h>
+
+//-------- 
+// xoshiro128+ ( 16 oCg,  2^128 - 1) , 4{ׂ SSE2 ł܂Ƃ߂Đi߂
+// 1̎킩 jump ŏdȂȂn؂oČn (ΉԂȂ) , ԂƂɔẑ,
+// Xbhŉ񂵂Ă킩͓ʂɂȂ
+//
+// ʂ̃rbĝ͎, gƂ below ŏʂ̃rbgg
+namespace rng{
+    // 64bit ̎L (splitmix64)
+    inline std::uint64_t splitmix64(std::uint64_t &x){
+        std::uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // x ̏ʂ̃rbg [0, n) Ɏʂ
+    inline std::uint32_t below(std::uint32_t x, std::uint32_t n){
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(x) * n) >> 32);
+    }
+
+    class xoshiro128{
+    public:
+        explicit xoshiro128(std::uint64_t seed = 0){
+            std::uint64_t a = splitmix64(seed), b = splitmix64(seed);
+            s_[0] = static_cast<std::uint32_t>(a);
+            s_[1] = static_cast<std::uint32_t>(a >> 32);
+            s_[2] = static_cast<std::uint32_t>(b);
+            s_[3] = static_cast<std::uint32_t>(b >> 32);
+        }
+
+        std::uint32_t operator ()(){
+            const std::uint32_t result = s_[0] + s_[3];
+            const std::uint32_t t = s_[1] << 9;
+            s_[2] ^= s_[0];
+            s_[3] ^= s_[1];
+            s_[1] ^= s_[2];
+            s_[0] ^= s_[3];
+            s_[2] ^= t;
+            s_[3] = (s_[3] << 11) | (s_[3] >> 21);
+            return result;
+        }
+
+        // [0, n)
+        std::uint32_t below(std::uint32_t n){
+            return rng::below((*this)(), n);
+        }
+
+        // [0, 1)
+        float uniform(){
+            return ((*this)() >> 8) * (1.0f / 16777216.0f);
+        }
+
+        // 2^64 񕪐i߂
+        void jump(){
+            static const std::uint32_t table[] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+            apply(table);
+        }
+
+        // 2^96 񕪐i߂
+        void long_jump(){
+            static const std::uint32_t table[] = { 0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662 };
+            apply(table);
+        }
+
+    private:
+        friend class xoshiro128x4;
+
+        void apply(const std::uint32_t (&table)[4]){
+            std::uint32_t s[4] = { 0, 0, 0, 0 };
+            for(std::uint32_t word : table){
+                for(int b = 0; b < 32; ++b){
+                    if(word & (1u << b)){
+                        for(int i = 0; i < 4; ++i){
+                            s[i] ^= s_[i];
+                        }
+                    }
+                    (*this)();
+                }
+            }
+            for(int i = 0; i < 4; ++i){
+                s_[i] = s[i];
+            }
+        }
+
+        std::uint32_t s_[4];
+    };
+
+    // base  0, 1, 2, 3  jump 4{̌nׂēɐi߂
+    // fill  i Ԗڂ̏o͂ (i % 4) {ڂ̌n񂩂
+    class xoshiro128x4{
+    public:
+        explicit xoshiro128x4(xoshiro128 base){
+            for(int lane = 0; lane < 4; ++lane){
+                for(int i = 0; i < 4; ++i){
+                    s_[i][lane] = base.s_[i];
+                }
+                base.jump();
+            }
+        }
+
+        // out[n] 𖄂߂
+        void fill(std::uint32_t *out, std::size_t n){
+            __m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(s_[0]));
+            __m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(s_[1]));
+            __m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(s_[2]));
+            __m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(s_[3]));
+            std::size_t i = 0;
+            while(i < n){
+                const __m128i result = _mm_add_epi32(s0, s3);
+                const __m128i t = _mm_slli_epi32(s1, 9);
+                s2 = _mm_xor_si128(s2, s0);
+                s3 = _mm_xor_si128(s3, s1);
+                s1 = _mm_xor_si128(s1, s2);
+                s0 = _mm_xor_si128(s0, s3);
+                s2 = _mm_xor_si128(s2, t);
+                s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+                if(n - i >= 4){
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+                    i += 4;
+                }else{
+                    // [̎̕ĉ͎Ă
+                    alignas(16) std::uint32_t rest[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(rest), result);
+                    for(int k = 0; i < n; ++k){
+                        out[i++] = rest[k];
+                    }
+                }
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(s_[0]), s0);
+            _mm_store_si128(reinterpret_cast<__m128i*>(s_[1]), s1);
+            _mm_store_si128(reinterpret_cast<__m128i*>(s_[2]), s2);
+            _mm_store_si128(reinterpret_cast<__m128i*>(s_[3]), s3);
+        }
+
+    private:
+        // s_[Ԃ̉Ԗڂ][n]
+        alignas(16) std::uint32_t s_[4][4];
+    };
+
+    // 1̎킩n, ԂƂɏdȂȂnz
+    // n system  long_jump, ̒̋ lane  jump Ő؂o
+    // (n 2^32 {, 1{ 2^64 ܂ŏdȂȂ)
+    class streams{
+    public:
+        explicit streams(std::uint64_t seed) : base_(seed){}
+
+        xoshiro128 get(unsigned system, unsigned lane = 0) const{
+            xoshiro128 r = base_;
+            for(unsigned i = 0; i < system; ++i){
+                r.long_jump();
+            }
+            for(unsigned i = 0; i < lane; ++i){
+                r.jump();
+            }
+            return r;
+        }
+
+    private:
+        xoshiro128 base_;
+    };
+}
@@ -2,331 +2,160 @@
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <string>
+#include <vector>
 #include <atomic>
-#include <complex>
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
-#include <portaudio.h>
 #include "audiodecoder.h"
+#include "resampler.hpp"
+#include "spectrum.hpp"
+#include "playlist.hpp"
+#include "mixer.hpp"
+#include "spsc_ring.hpp"
+#include "audio_session.hpp"
 #include "bmp.hpp"
 
 extern std::atomic<bool> is_running;
 
 namespace sound_effect{
-    extern PaStream *hit_stream;
-    extern std::unique_ptr<AudioDecoder> hit;
+    extern mixer::clip hit;
+    extern int hit_interval;
+    extern const int hit_interval_frames;
 }
 
 namespace object{
     extern volatile float peek_spectrum[2][256];
 }
 
-#define PA_SAMPLE_TYPE paFloat32
 using sample_t = float;
 
-using complex_t = std::complex<float>;
-
-// rbg𓾂
-int bit_num(int t){
-    int n = 0;
-    while(t > 0){
-        ++n;
-        t >>= 1;
-    }
-    return n;
-}
-
-// rbg𔽓]
-int bit_rev(int a){
-    if(a == 0){
-        return a;
-    }
-    int n = bit_num(a);
-    int r = 0;
-    if(n % 2 == 1){
-        r |= ((a >> (n / 2)) & 1) << (n / 2);
-    }
-    for(int i = 0; i < n / 2; ++i){
-        r |= ((a >> i) & 1) << (n - 1 - i);
-        r |= ((a >> (n - 1 - i)) & 1) << i;
-    }
-    return r;
-}
-
-// rbgo[XRs[ (hann)
-void bit_rev_copy_hann(const float *a, complex_t *A, int n){
-    for(int i = 0; i < n; ++i){
-        A[bit_rev(i)] = a[i] * (0.5 - 0.5 * std::cos(2.0 * M_PI * i / n));
-    }
-}
-
-// rbgo[XRs[ (vorbis)
-void bit_rev_copy_vorbis(const float *a, complex_t *A, int n){
-    for(int i = 0; i < n; ++i){
-        float v = std::sin(M_PI * i / n);
-        v *= v;
-        A[bit_rev(i)] = a[i] * std::sin(M_PI * v / 2);
-    }
-}
-
-// vf2^lg_nFFT
-// a[1 << lg_n] : input
-// A[1 << lg_n] : output
-void fft(const float *a, complex_t *A, int lg_n){
-    int n = 1 << lg_n;
-    bit_rev_copy_vorbis(a, A, n);
-    for(int s = 1; s <= lg_n; ++s){
-        int m = 1 << s;
-        complex_t omega_m(std::cos(2.0 * M_PI / m), std::sin(2.0 * M_PI / m)), omega = 1.0;
-        for(int j = 0; j < m / 2; ++j){
-            for(int k = j; k < n; k += m){
-                complex_t t = omega * A[k + m / 2], u = A[k];
-                A[k] = u + t;
-                A[k + m / 2] = u - t;
-            }
-            omega *= omega_m;
-        }
-    }
-}
-
 extern int ch_num;
 int ch_num;
 
 extern std::atomic<float> progress;
-unsigned long progress_per_samples;
 
-const int lg_spectrum_length = 8;
 extern const int spectrum_length;
-const int spectrum_length = 1 << lg_spectrum_length;
-
-static float fft_input_signal[spectrum_length * 2];
-static complex_t fft_output_signal[spectrum_length * 2];
+const int spectrum_length = spectrum::length;
 
 extern float fft_max_power;
-float fft_max_power = 0.0;
+float fft_max_power = spectrum::max_power();
 
-float power(const complex_t &c){
-    return c.real() * c.real() + c.imag() * c.imag();
-}
-
-struct fft_max_power_initer_type{
-    fft_max_power_initer_type(){
-        for(int i = 0; i < spectrum_length * 2; ++i){
-            fft_input_signal[i] = std::sin((spectrum_length / 2) * 2.0 * M_PI * static_cast<float>(i) / (spectrum_length * 2));
-        }
-        fft(fft_input_signal, fft_output_signal, lg_spectrum_length);
-        for(int i = 0; i < spectrum_length; ++i){
-            float v = power(fft_output_signal[i]);
-            if(v > fft_max_power){
-                fft_max_power = v;
-            }
-        }
-    }
-} fft_max_power_initer;
-
-const int buffer_length = 1024;
-volatile float volume_subst[2][buffer_length];
-extern volatile float *volume[2];
-volatile float *volume[2] = { volume_subst[0], volume_subst[1] };
+// Xg[̃obt@
+// ͂ spectrum::block_accumulator œƎ̊Ԋuōŝŏo͐ɔC
+extern const unsigned long buffer_length;
+const unsigned long buffer_length = audio_output::frames_unspecified;
 
 namespace clover_system{
-    extern std::atomic<bool> now_playing;
-    extern std::unique_ptr<AudioDecoder> decoder;
-    extern PaStream *stream;
+    extern playlist::engine music;
+    extern mixer::engine audio;
 }
 
-void play_sound(){
-    using namespace std::literals;
-    using namespace clover_system;
-    PaError err;
-
-    ch_num = decoder->channels();
-
-    progress = 0.0;
-    progress_per_samples = 0;
-    
-    PaStreamParameters outputParameters;
-    outputParameters.device = Pa_GetDefaultOutputDevice();
-    outputParameters.channelCount = decoder->channels();
-    outputParameters.sampleFormat = PA_SAMPLE_TYPE;
-    outputParameters.suggestedLatency = Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
-    outputParameters.hostApiSpecificStreamInfo = NULL;
-
-    int (*callback)(
-        const void *inputBuffer,
-        void *outputBuffer,
-        unsigned long framesPerBuffer,
-        const PaStreamCallbackTimeInfo* timeInfo,
-        PaStreamCallbackFlags statusFlags,
-        void *userData
-    );
-
-    callback = [](
-        const void *inputBuffer,
-        void *outputBuffer,
-        unsigned long frameCount,
-        const PaStreamCallbackTimeInfo* timeInfo,
-        PaStreamCallbackFlags statusFlags,
-        void *userData
-    ) -> int{
-        if(!is_running){
-            now_playing = false;
-            return paComplete;
-        }
-
-        AudioDecoder *data = (AudioDecoder*)userData;
-        sample_t *out = (sample_t*)outputBuffer;
-
-        std::memset(out, 0, frameCount * data->channels() * sizeof(sample_t));
-        int samplesRead = data->read(frameCount * data->channels(), out);
-        progress_per_samples += frameCount;
-
-        int channels = data->channels();
-        int len = data->numSamples() / channels;
-        progress = static_cast<float>(progress_per_samples) / static_cast<float>(len);
-
-        int n = static_cast<int>(sizeof(fft_input_signal) / sizeof(fft_input_signal[0]));
-        int m = 4;
-        for(int ch = 0; ch < 2; ++ch){
-            if(ch == 1 && ch_num == 1){
-                break;
-            }
-
-            for(int i = 0; i < buffer_length; ++i){
-                volume[ch][i] = 0.0;
-            }
-
-            for(int j = 0; j < buffer_length / m - (spectrum_length / m); ++j){
-                std::memset(fft_input_signal, 0, sizeof(fft_input_signal));
-                std::memset(fft_output_signal, 0, sizeof(fft_output_signal));
-                for(int i = 0; i < n; ++i){
-                    fft_input_signal[i] = out[j * m * channels + i * channels + ch];
-                }
-                fft(fft_input_signal, fft_output_signal, lg_spectrum_length);
-
-                for(int i = 0; i < spectrum_length; ++i){
-                    float w = power(fft_output_signal[i]);
-                    float v = w / fft_max_power;
-                    volume[ch][j * m + i] += v / m;
-                }
-            }
-        }
-
-        const int spectrum_size = sizeof(object::peek_spectrum[0]) / sizeof(object::peek_spectrum[0][0]);
-        for(int i = 0; i < spectrum_size; ++i){
-            for(int ch = 0; ch < 2; ++ch){
-                if(ch == 1 && ch_num == 1){
-                    break;
-                }
+// Tv̕i
+extern resampler::quality resample_quality;
+resampler::quality resample_quality = resampler::quality::medium;
+
+// 1ubN̉͌
+// R[obNŏۂɕ̂̓foCX̒x̕Ȃ̂,
+// DACo鎞tăQ[Xbhɓn, ̎ɂȂĂg
+struct analysis_frame{
+    // ubN̐擪DACo鎞 (mixer::engine::time Ɠv)
+    double dac_time;
+    float progress;
+    int channels;
+    float band[2][spectrum::bands];
+};
+
+// I[fBIR[obN -> Q[Xbh
+static spsc_ring<analysis_frame, 64> analysis_frames;
+
+// y~LT[ɗ (I[fBIR[obNĂ΂)
+static void render_music(sample_t *out, int frames, double dac_time, void *user){
+    if(!is_running){
+        return;
+    }
 
-                float sum = 0.0;
-                for(int j = 0; j < buffer_length / spectrum_size; ++j){
-                    sum += volume[ch][i * (buffer_length / spectrum_size) + j];
-                }
-                object::peek_spectrum[ch][i] = sum;
+    playlist::engine *data = (playlist::engine*)user;
+    const int channels = mixer::channels;
+    data->read(out, frames);
+    ch_num = data->source_channels();
+
+    // foCX̃obt@Ɋ֌WȂ block_hop Ƃɉ͂
+    static spectrum::block_accumulator accumulator(channels);
+    static spectrum::analyzer analyzer;
+    static analysis_frame frame;
+    const double rate = clover_system::audio.rate();
+    accumulator.push(out, frames, [&](const float *block, int end){
+        long long len = data->length();
+        frame.dac_time = dac_time + (end - spectrum::block_frames) / rate;
+        frame.progress = len > 0 ? static_cast<float>(data->position()) / static_cast<float>(len) : 0.0f;
+        frame.channels = ch_num == 1 ? 1 : 2;
+
+        // ш悲Ƃ̉
+        // tools/analyze ̃LbV΂g. ubNȂ̋ڂ܂Ƃ͉͂
+        const long long start = data->position() - (frames - end) - spectrum::block_frames;
+        for(int ch = 0; ch < frame.channels; ++ch){
+            if(!data->cached_bands(start, ch, frame.band[ch])){
+                analyzer.run(block, channels, ch, frame.band[ch]);
             }
         }
 
-        if(progress_per_samples < static_cast<unsigned long>(len)){
-            return paContinue;
-        }else{
-            return paComplete;
-        }
-    };
+        // Q[Xbh~܂ĂĈtȂ̂Ă
+        analysis_frames.push(frame);
+    });
+}
 
-    err = Pa_OpenDefaultStream(
-        &stream,
-        0,
-        decoder->channels(),
-        paFloat32,
-        decoder->sampleRate(),
-        buffer_length,
-        callback,
-        decoder.get()
-    );
-    if(err != paNoError){
-        Pa_Terminate();
-        std::abort();
+// ĂubN̉͌ʂ peek_spectrum  progress ɔf
+// Q[Xbh疈t[Ă. ǂݐi߂ubNԂ
+int sync_audible_spectrum(){
+    const double now = clover_system::audio.time();
+    const analysis_frame *front;
+    analysis_frame frame;
+    int count = 0;
+    while((front = analysis_frames.front()) != nullptr && front->dac_time <= now){
+        analysis_frames.pop(frame);
+        ++count;
     }
-
-    //Đ
-    Pa_StartStream(stream);
-    now_playing = true;
-
-    // X[v
-    while(now_playing){
-        std::this_thread::sleep_for(1s);
+    if(count == 0){
+        return 0;
     }
 
-    Pa_CloseStream(stream);
-    stream = nullptr;
+    progress = frame.progress;
+    for(int ch = 0; ch < frame.channels; ++ch){
+        for(int i = 0; i < spectrum::bands; ++i){
+            object::peek_spectrum[ch][i] = frame.band[ch][i];
+        }
+    }
+    return count;
 }
 
-void play_hit_sound(){
-    sound_effect::hit->seek(0);
-    static std::atomic_bool now_playing = false;
+// Ȃ̊Jn/؂ւ/~͍ĐZbṼXbhs
+static audio_session::session session(clover_system::audio, clover_system::music, render_music);
 
-    PaError err;
-    PaStreamParameters outputParameters;
-    outputParameters.device = Pa_GetDefaultOutputDevice();
-    outputParameters.channelCount = sound_effect::hit->channels();
-    outputParameters.sampleFormat = PA_SAMPLE_TYPE;
-    outputParameters.suggestedLatency = Pa_GetDeviceInfo(outputParameters.device)->defaultLowOutputLatency;
-    outputParameters.hostApiSpecificStreamInfo = NULL;
+// paths ̋ȂɌpڂȂĐ
+// vςނłɖ߂. Đ̋Ȃΐ؂ւ
+void play_sound(std::vector<std::string> paths){
+    progress = 0.0;
+    session.play(std::move(paths), resample_quality);
+}
 
-    int (*callback)(
-        const void *inputBuffer,
-        void *outputBuffer,
-        unsigned long framesPerBuffer,
-        const PaStreamCallbackTimeInfo* timeInfo,
-        PaStreamCallbackFlags statusFlags,
-        void *userData
-    );
+// ߂ play_sound 1ȂJȂ
+bool take_playback_failure(){
+    return session.take_failure();
+}
 
-    callback = [](
-        const void *inputBuffer,
-        void *outputBuffer,
-        unsigned long frameCount,
-        const PaStreamCallbackTimeInfo* timeInfo,
-        PaStreamCallbackFlags statusFlags,
-        void *userData
-    ) -> int{
-        AudioDecoder *data = (AudioDecoder*)userData;
-        sample_t *out = (sample_t*)outputBuffer;
-        std::memset(out, 0, frameCount * data->channels() * sizeof(sample_t));
-        data->read(frameCount * data->channels(), out);
-        if(data->positionInSamples() >= data->numSamples()){
-            return paComplete;
-        }else{
-            now_playing = false;
-            return paContinue;
-        }
-    };
+// ~LT[OɌĂ
+void shutdown_sound(){
+    session.shutdown();
+}
 
-    if(!now_playing){
-        static bool once = false;
-        if(!once){
-            err = Pa_OpenDefaultStream(
-                &sound_effect::hit_stream,
-                0,
-                sound_effect::hit->channels(),
-                paFloat32,
-                sound_effect::hit->sampleRate(),
-                buffer_length,
-                callback,
-                sound_effect::hit.get()
-            );
-            if(err != paNoError){
-                Pa_Terminate();
-                std::abort();
-            }
-            once = true;
-        }
-        now_playing = true;
-        Pa_StartStream(sound_effect::hit_stream);
-    }else{
-        Pa_StartStream(sound_effect::hit_stream);
+// ʉ̍Đ̓L[ɐςނ
+void play_hit_sound(){
+    if(sound_effect::hit_interval > 0){
+        return;
     }
+    clover_system::audio.play(sound_effect::hit);
+    sound_effect::hit_interval = sound_effect::hit_interval_frames;
 }
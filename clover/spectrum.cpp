@@ -0,0 +1,258 @@
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "spectrum.hpp"
+
+namespace spectrum{
+    // rbg𓾂
+    static int bit_num(int t){
+        int n = 0;
+        while(t > 0){
+            ++n;
+            t >>= 1;
+        }
+        return n;
+    }
+
+    // rbg𔽓]
+    static int bit_rev(int a){
+        if(a == 0){
+            return a;
+        }
+        int n = bit_num(a);
+        int r = 0;
+        if(n % 2 == 1){
+            r |= ((a >> (n / 2)) & 1) << (n / 2);
+        }
+        for(int i = 0; i < n / 2; ++i){
+            r |= ((a >> i) & 1) << (n - 1 - i);
+            r |= ((a >> (n - 1 - i)) & 1) << i;
+        }
+        return r;
+    }
+
+    // rbgo[XRs[ (vorbis)
+    // a  stride vfɓǂ
+    static void bit_rev_copy_vorbis(const float *a, complex_t *A, int n, int stride){
+        for(int i = 0; i < n; ++i){
+            float v = std::sin(M_PI * i / n);
+            v *= v;
+            A[bit_rev(i)] = a[i * stride] * std::sin(M_PI * v / 2);
+        }
+    }
+
+    float power(const complex_t &c){
+        return c.real() * c.real() + c.imag() * c.imag();
+    }
+
+    namespace{
+        // ͒ length p̑/rbgo[X/]q̕\Ă
+        struct tables{
+            int rev[length];
+            float window[length];
+            complex_t twiddle[length / 2];
+
+            tables(){
+                for(int i = 0; i < length; ++i){
+                    rev[i] = bit_rev(i);
+                    float v = std::sin(M_PI * i / length);
+                    v *= v;
+                    window[i] = std::sin(M_PI * v / 2);
+                }
+                for(int i = 0; i < length / 2; ++i){
+                    twiddle[i] = complex_t(std::cos(2.0 * M_PI * i / length), std::sin(2.0 * M_PI * i / length));
+                }
+            }
+        };
+
+        const tables &get_tables(){
+            static const tables t;
+            return t;
+        }
+    }
+
+    void fft(const float *a, complex_t *A, int lg_n, int stride){
+        int n = 1 << lg_n;
+
+        // bit_rev  0..n-1 ̕בւɂȂĂȂ̂ŏȂvf
+        std::fill(A, A + n, complex_t());
+        if(n != length){
+            // \̖͖vZ
+            bit_rev_copy_vorbis(a, A, n, stride);
+            for(int s = 1; s <= lg_n; ++s){
+                int m = 1 << s;
+                complex_t omega_m(std::cos(2.0 * M_PI / m), std::sin(2.0 * M_PI / m)), omega = 1.0;
+                for(int j = 0; j < m / 2; ++j){
+                    for(int k = j; k < n; k += m){
+                        complex_t t = omega * A[k + m / 2], u = A[k];
+                        A[k] = u + t;
+                        A[k + m / 2] = u - t;
+                    }
+                    omega *= omega_m;
+                }
+            }
+            return;
+        }
+
+        const tables &t = get_tables();
+        for(int i = 0; i < length; ++i){
+            A[t.rev[i]] = a[i * stride] * t.window[i];
+        }
+        for(int s = 1; s <= lg_length; ++s){
+            int m = 1 << s, step = length >> s;
+            for(int j = 0; j < m / 2; ++j){
+                const float wr = t.twiddle[j * step].real(), wi = t.twiddle[j * step].imag();
+                for(int k = j; k < length; k += m){
+                    // std::complex ̏Z inf/nan ̈̂߂ɒx̂œWJ
+                    const complex_t b = A[k + m / 2], u = A[k];
+                    const complex_t w(wr * b.real() - wi * b.imag(), wr * b.imag() + wi * b.real());
+                    A[k] = complex_t(u.real() + w.real(), u.imag() + w.imag());
+                    A[k + m / 2] = complex_t(u.real() - w.real(), u.imag() - w.imag());
+                }
+            }
+        }
+    }
+
+    float max_power(){
+        static const float value = [](){
+            float input[length * 2];
+            complex_t output[length * 2];
+            for(int i = 0; i < length * 2; ++i){
+                input[i] = std::sin((length / 2) * 2.0 * M_PI * static_cast<float>(i) / (length * 2));
+            }
+            fft(input, output, lg_length);
+            float max = 0.0;
+            for(int i = 0; i < length; ++i){
+                float v = power(output[i]);
+                if(v > max){
+                    max = v;
+                }
+            }
+            return max;
+        }();
+        return value;
+    }
+
+    void analyzer::run(const float *in, int channels, int ch, float *band){
+        const float max = max_power();
+        for(int i = 0; i < block_frames; ++i){
+            volume_[i] = 0.0;
+        }
+
+        for(int j = 0; j < block_frames / hop - (length / hop); ++j){
+            // ͂璼ڑ؂o
+            fft(in + j * hop * channels + ch, output_, lg_length, channels);
+            for(int i = 0; i < length; ++i){
+                float v = power(output_[i]) / max;
+                volume_[j * hop + i] += v / hop;
+            }
+        }
+
+        for(int i = 0; i < bands; ++i){
+            float sum = 0.0;
+            for(int j = 0; j < block_frames / bands; ++j){
+                sum += volume_[i * (block_frames / bands) + j];
+            }
+            band[i] = sum;
+        }
+    }
+
+    float onset(const float *prev_band, const float *band){
+        float flux = 0.0;
+        for(int i = 0; i < bands; ++i){
+            float d = band[i] - prev_band[i];
+            if(d > 0.0){
+                flux += d;
+            }
+        }
+        return flux;
+    }
+
+    // log2  -48  +16 ܂ł\
+    static const float band_log_min = -48.0f;
+    static const float band_steps = 1024.0f;
+
+    std::uint16_t encode_band(float v){
+        if(!(v > 0.0f)){
+            return 0;
+        }
+        float q = (std::log2(v) - band_log_min) * band_steps;
+        if(q < 1.0f){
+            return 1;
+        }
+        if(q > 65535.0f){
+            return 65535;
+        }
+        return static_cast<std::uint16_t>(q + 0.5f);
+    }
+
+    float decode_band(std::uint16_t q){
+        if(q == 0){
+            return 0.0f;
+        }
+        return std::exp2(q / band_steps + band_log_min);
+    }
+
+    bool track_stamp(const std::string &track, std::int64_t *size, std::int64_t *time){
+#ifdef _WIN32
+        struct _stat64 st;
+        if(_stat64(track.c_str(), &st) != 0){
+            return false;
+        }
+#else
+        struct stat st;
+        if(stat(track.c_str(), &st) != 0){
+            return false;
+        }
+#endif
+        *size = st.st_size;
+        *time = st.st_mtime;
+        return true;
+    }
+
+    bool cache::load(const std::string &track, int sample_rate){
+        channels_ = 0;
+        blocks_ = 0;
+        bands_.clear();
+
+        std::int64_t size, time;
+        std::ifstream ifs(cache_path(track), std::ios::binary);
+        cache_header h;
+        if(!track_stamp(track, &size, &time) || !ifs.read(reinterpret_cast<char*>(&h), sizeof(h))
+            || std::memcmp(h.magic, cache_magic, sizeof(h.magic)) != 0 || h.version != cache_version
+            || h.track_size != size || h.track_time != time
+            || h.sample_rate != static_cast<std::uint32_t>(sample_rate)
+            || h.block_frames != static_cast<std::uint32_t>(block_frames) || h.bands != static_cast<std::uint32_t>(bands)
+            || h.channels < 1 || h.channels > 2){
+            return false;
+        }
+
+        // オ̓Q[ł͎gȂ̂œǂݔ΂
+        const std::size_t band_num = h.channels * bands;
+        std::vector<std::uint16_t> packed(static_cast<std::size_t>(h.blocks) * band_num);
+        for(std::uint64_t i = 0; i < h.blocks; ++i){
+            if(!ifs.read(reinterpret_cast<char*>(&packed[i * band_num]), band_num * sizeof(std::uint16_t))){
+                return false;
+            }
+            ifs.seekg(h.channels * sizeof(float), std::ios::cur);
+        }
+        bands_.swap(packed);
+        blocks_ = static_cast<long long>(h.blocks);
+        channels_ = static_cast<int>(h.channels);
+        return true;
+    }
+
+    bool cache::read(long long block, int ch, float *band) const{
+        if(block < 0 || block >= blocks_ || ch >= channels_){
+            return false;
+        }
+        const std::uint16_t *packed = &bands_[(block * channels_ + ch) * bands];
+        for(int i = 0; i < bands; ++i){
+            band[i] = decode_band(packed[i]);
+        }
+        return true;
+    }
+}
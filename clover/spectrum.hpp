@@ -0,0 +1,152 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+//-------- XyNg
+// Q[̃I[fBIR[obNƉ̓c[ (tools/analyze) œ̂g
+namespace spectrum{
+    using complex_t = std::complex<float>;
+
+    // FFT͒
+    const int lg_length = 8;
+    const int length = 1 << lg_length;
+
+    // 1̉͂ňt[ (Xg[̃obt@Ƃ͖֌W)
+    const int block_frames = 1024;
+
+    // ͂ubN炷 (t[)
+    const int block_hop = block_frames;
+
+    // 炷 (t[)
+    const int hop = 4;
+
+    // o͂ш̐
+    const int bands = 256;
+
+    float power(const complex_t &c);
+
+    // vf2^lg_nFFT
+    // a[(1 << lg_n) * stride] : input (C^[[uꂽobt@1`l𒼐ړn)
+    // A[1 << lg_n] : output
+    void fft(const float *a, complex_t *A, int lg_n, int stride = 1);
+
+    // KɎgFFTp[̏
+    float max_power();
+
+    // 1ubN̉
+    class analyzer{
+    public:
+        // block_frames t[̃C^[[uꂽM in  ch `l͂
+        // ш悲Ƃ̉ʂ band[bands] ɏ
+        void run(const float *in, int channels, int ch, float *band);
+
+    private:
+        complex_t output_[length];
+        float volume_[block_frames];
+    };
+
+    // Cӂ̒œ͂C^[[uꂽM𗭂߂,
+    // block_hop t[Ƃɒ block_frames t[̃ubNn
+    // foCX̃obt@t[ł (ĂԂтɈĂ) ͂̊Ԋu͕ςȂ
+    class block_accumulator{
+    public:
+        explicit block_accumulator(int channels) : channels_(channels), buffer_(block_frames * channels){}
+
+        // in[frames * channels] 𑫂
+        // ubNт on_block(block, end) Ă
+        // end ̓ubN̍Ō̃t[̎ in ̉t[ڂɓ邩
+        template<class F>
+        void push(const float *in, int frames, F on_block){
+            int pos = 0;
+            while(pos < frames){
+                int n = std::min(frames - pos, block_frames - filled_);
+                std::memcpy(&buffer_[filled_ * channels_], in + pos * channels_, n * channels_ * sizeof(float));
+                filled_ += n;
+                pos += n;
+                if(filled_ == block_frames){
+                    on_block(static_cast<const float*>(buffer_.data()), pos);
+                    // ̃ubNƏdȂ镔Oɋl߂
+                    filled_ = block_frames - block_hop;
+                    std::memmove(buffer_.data(), &buffer_[block_hop * channels_], filled_ * channels_ * sizeof(float));
+                }
+            }
+        }
+
+        void reset(){
+            filled_ = 0;
+        }
+
+    private:
+        int channels_;
+        int filled_ = 0;
+        std::vector<float> buffer_;
+    };
+
+    // ÕubN̗オ̋ (ш悲Ƃ̘̑a)
+    float onset(const float *prev_band, const float *band);
+
+    //-------- ͌ʂ̃LbVt@C (tools/analyze ȂƂɏ)
+    // Q[ƓXg[̃Tv[gɕϊĂ͂
+    // cache_header ̌ɃubNƂ
+    //   std::uint16_t band[channels][bands] : encode_band ш悲Ƃ̉
+    //   float onset[channels]               : ÕubN̗オ
+    // 
+    struct cache_header{
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t channels;
+        std::uint32_t sample_rate;
+        std::uint32_t block_frames;
+        std::uint32_t bands;
+        std::uint64_t blocks;
+        // Ȃς蒼
+        std::int64_t track_size;
+        std::int64_t track_time;
+    };
+
+    const char cache_magic[4] = { 'C', 'S', 'P', 'C' };
+    const std::uint32_t cache_version = 2;
+
+    // ȂɑΉLbṼpX
+    inline std::string cache_path(const std::string &track){
+        return track + ".spec";
+    }
+
+    // ʂ log2  1/1024 Pʂ 16bit ɋl߂ (0 ͖)
+    std::uint16_t encode_band(float v);
+    float decode_band(std::uint16_t q);
+
+    // ȃt@C̑傫ƍXV. LbVÂȂ𒲂ׂ̂Ɏg
+    bool track_stamp(const std::string &track, std::int64_t *size, std::int64_t *time);
+
+    // ǂݍ񂾃LbV
+    // Đ̓I[fBIR[obN bands ĂŎԂ̉͂̑ɂ
+    class cache{
+    public:
+        // track ̃LbV sample_rate ŉ͂ĂċȂςĂȂΓǂ
+        // t@Cǂނ̂Ń[J[XbhŌĂ
+        bool load(const std::string &track, int sample_rate);
+
+        bool loaded() const{
+            return channels_ > 0;
+        }
+
+        int channels() const{
+            return channels_;
+        }
+
+        // block Ԗڂ̃ubN ch `l̉ʂ band[bands] ɏ
+        // ubN false (ubLO̊mۂȂ)
+        bool read(long long block, int ch, float *band) const;
+
+    private:
+        int channels_ = 0;
+        long long blocks_ = 0;
+        std::vector<std::uint16_t> bands_;
+    };
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//-------- PꐶY/P҂̃bNt[Oobt@
+// I[fBIR[obNƑXbh̊ԂŒl󂯓n̂Ɏg
+// N 2̗ݏ
+template<class T, std::size_t N>
+class spsc_ring{
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+    spsc_ring() : head_(0), tail_(0){}
+
+    // Yґ : tȂ false
+    bool push(const T &v){
+        std::size_t t = tail_.load(std::memory_order_relaxed);
+        if(t - head_.load(std::memory_order_acquire) == N){
+            return false;
+        }
+        buf_[t & (N - 1)] = v;
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ґ : Ȃ false
+    bool pop(T &v){
+        std::size_t h = head_.load(std::memory_order_relaxed);
+        if(h == tail_.load(std::memory_order_acquire)){
+            return false;
+        }
+        v = buf_[h & (N - 1)];
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ґ : 擪oɌ. Ȃ nullptr
+    const T *front() const{
+        std::size_t h = head_.load(std::memory_order_relaxed);
+        if(h == tail_.load(std::memory_order_acquire)){
+            return nullptr;
+        }
+        return &buf_[h & (N - 1)];
+    }
+
+    bool empty() const{
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, N> buf_;
+    std::atomic<std::size_t> head_, tail_;
+};
@@ -0,0 +1,817 @@
+#pragma once
+
+#include <new>
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <tuple>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include "arena.hpp"
+#include "jobs.hpp"
+
+//-------- ^XN
+// tasklist         : Œ蒷̔z񂩂IuWFNgo, Ă̂oXgŉ
+// dense_tasklist   : Ă̂z̐擪ɋl߂Ď, 珇 (ۂɂ͌납) 
+// chunked_tasklist : dense_tasklist Ɠ, tɂȂƃubNpđ
+// world            : IuWFNg̎ނƂ̓ꕨ܂Ƃ߂Ď, ܂ɉ
+namespace object{
+    template<class T>
+    struct task{
+        T obj;
+        task *next, *prev;
+        int thread;
+    };
+
+    // ^XNɂIuWFNg̊
+    // z֐͎g킸, tasklist<T, N>  T ̃o𒼐ڌĂ (ÓIȑ)
+    // T ͕KvȂ̂OŒ`ĉB
+    template<class T>
+    struct object{
+        // ^XNɃR[
+        void ctor(){}
+
+        // ^XNjɃR[
+        void dtor(){}
+
+        // `掞ɃR[
+        void draw() const{}
+
+        // ^XNĂяoɃR[
+        // void update(task<T> *&t);  T K`
+    };
+
+    // v[̎gp
+    struct pool_stats{
+        // Ă鐔
+        std::size_t size;
+
+        // mۂĂ鐔
+        std::size_t capacity;
+
+        // ȏ͑Ȃ (0 ȂȂ)
+        std::size_t limit;
+
+        // size ̍ől
+        std::size_t high_water;
+
+        // 
+        std::size_t spawned;
+
+        // tŐłȂ
+        std::size_t drops;
+    };
+
+    template<class T, std::size_t N>
+    class tasklist{
+    private:
+        using task = ::object::task<T>;
+        std::size_t size_ = 0, high_water_ = 0, spawned_ = 0, drops_ = 0;
+        task active_ , *free_;
+        std::array<task, N> arr;
+
+    public:
+        task &active = active_;
+
+        tasklist(){
+            for(int i = 0; i < N - 1; ++i){
+                arr[i].next = &arr[i + 1];
+            }
+            arr[N - 1].next = nullptr;
+            free_ = &arr[0];
+
+            active_.next = &active_;
+            active_.prev = &active_;
+        }
+
+        ~tasklist() = default;
+
+        // ^XN𐶐
+        task *create_task(){
+            if(size_ == N){
+                ++drops_;
+                return nullptr;
+            }
+            ++size_;
+            ++spawned_;
+            high_water_ = std::max(high_water_, size_);
+            task *t = free_;
+            free_ = free_->next;
+            active_.next->prev = t;
+            t->next = active_.next;
+            active_.next = t;
+            t->prev = &active_;
+            t->obj.ctor();
+            return t;
+        }
+
+        // ^XN폜
+        task *delete_task(task *t){
+            t->obj.dtor();
+            --size_;
+            task *r = t->prev, *s = t->next;
+            t->prev->next = t->next;
+            if(t->next){
+                t->next->prev = t->prev;
+            }
+            t->next = free_;
+            free_ = t;
+            return r;
+        }
+
+        // NA
+        void clear(){
+            if(size_ == 0){
+                return;
+            }
+            while(active_.next != &active_){
+                delete_task(active_.next);
+            }
+            active_.next = &active_;
+            active_.prev = &active_;
+            size_ = 0;
+        }
+
+        // 
+        bool empty() const{
+            return size_ == 0;
+        }
+
+        // ݂̃TCY
+        std::size_t size() const{
+            return size_;
+        }
+
+        pool_stats stats() const{
+            pool_stats s;
+            s.size = size_;
+            s.capacity = s.limit = N;
+            s.high_water = high_water_;
+            s.spawned = spawned_;
+            s.drops = drops_;
+            return s;
+        }
+
+        // ^XN
+        void update(){
+            task *t = active_.next;
+            while(t != &active_){
+                t->obj.update(t);
+                if(t != &active_){
+                    t = t->next;
+                }
+            }
+        }
+
+        // `^XN
+        void draw() const{
+            task *t = active_.next;
+            while(t != &active_){
+                t->obj.draw();
+                t = t->next;
+            }
+        }
+    };
+
+    // dense_tasklist 1ubN
+    template<class T, std::size_t C>
+    struct dense_chunk{
+        struct slot_type{
+            // vf̈ʒu
+            std::uint32_t index;
+            // 폜邽тɐi߂
+            std::uint32_t generation;
+        };
+
+        std::array<T, C> items;
+        std::array<std::uint32_t, C> slot_of;
+        std::array<slot_type, C> slots;
+        std::array<std::uint32_t, C> free_slots;
+    };
+
+    // Œ蒷̓ꕨ. ŏ N , Ȃ
+    template<class T, std::size_t N>
+    class fixed_storage{
+    public:
+        using chunk_type = dense_chunk<T, N>;
+        // release ŃubN邩
+        static const bool releasable = false;
+
+        std::size_t capacity() const{
+            return N;
+        }
+
+        std::size_t limit() const{
+            return N;
+        }
+
+        bool grow(){
+            return false;
+        }
+
+        // ͖̂
+        bool release(arena&){
+            return false;
+        }
+
+        T &item(std::size_t i){
+            return chunk_.items[i];
+        }
+
+        const T &item(std::size_t i) const{
+            return chunk_.items[i];
+        }
+
+        std::uint32_t &slot_of(std::size_t i){
+            return chunk_.slot_of[i];
+        }
+
+        typename chunk_type::slot_type &slot(std::size_t i){
+            return chunk_.slots[i];
+        }
+
+        std::uint32_t &free_slot(std::size_t i){
+            return chunk_.free_slots[i];
+        }
+
+        std::size_t index_of(const T *p) const{
+            return static_cast<std::size_t>(p - chunk_.items.data());
+        }
+
+    private:
+        chunk_type chunk_;
+    };
+
+    // dense_tasklist ̃ubN؂oA[i
+    inline arena &task_arena(){
+        static arena a;
+        return a;
+    }
+
+    // ChunkSize ̃ubNpĂꕨ
+    // ubN̓A[i (ŏ task_arena) ĕԂȂ̂, x͎g
+    // release őSẴubN, ʂ̃A[i蒼
+    // Limit  0 łȂ Limit  (ubNPʂɐ؂グ) Ŏ~܂
+    template<class T, std::size_t ChunkSize, std::size_t Limit = 0>
+    class chunked_storage{
+        static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+        // A[i̓fXgN^Ă΂ɂ܂Ƃ߂Ď̂Ă
+        static_assert(std::is_trivially_destructible<T>::value, "T must be trivially destructible");
+
+        static const std::size_t max_chunks = Limit == 0 ? ~std::size_t(0) : (Limit + ChunkSize - 1) / ChunkSize;
+
+    public:
+        using chunk_type = dense_chunk<T, ChunkSize>;
+        static const bool releasable = true;
+
+        std::size_t capacity() const{
+            return chunks_.size() * ChunkSize;
+        }
+
+        std::size_t limit() const{
+            return Limit == 0 ? 0 : max_chunks * ChunkSize;
+        }
+
+        // 1ubN. ɒBĂ false
+        bool grow(){
+            if(chunks_.size() >= max_chunks){
+                return false;
+            }
+            chunks_.push_back(new(arena_->allocate<chunk_type>()) chunk_type);
+            return true;
+        }
+
+        // SẴubN, ȍ~ a 
+        // ubN͌̃A[i reset ŕԂ
+        bool release(arena &a){
+            chunks_.clear();
+            arena_ = &a;
+            return true;
+        }
+
+        T &item(std::size_t i){
+            return chunks_[i / ChunkSize]->items[i % ChunkSize];
+        }
+
+        const T &item(std::size_t i) const{
+            return chunks_[i / ChunkSize]->items[i % ChunkSize];
+        }
+
+        std::uint32_t &slot_of(std::size_t i){
+            return chunks_[i / ChunkSize]->slot_of[i % ChunkSize];
+        }
+
+        typename chunk_type::slot_type &slot(std::size_t i){
+            return chunks_[i / ChunkSize]->slots[i % ChunkSize];
+        }
+
+        std::uint32_t &free_slot(std::size_t i){
+            return chunks_[i / ChunkSize]->free_slots[i % ChunkSize];
+        }
+
+        // p ̓ĂubNT (ubNׂ̐)
+        std::size_t index_of(const T *p) const{
+            for(std::size_t c = 0; c < chunks_.size(); ++c){
+                const T *first = chunks_[c]->items.data();
+                if(p >= first && p < first + ChunkSize){
+                    return c * ChunkSize + static_cast<std::size_t>(p - first);
+                }
+            }
+            return capacity();
+        }
+
+    private:
+        std::vector<chunk_type*> chunks_;
+        arena *arena_ = &task_arena();
+    };
+
+    // ĂIuWFNgz̐擪ɋl߂Ď^XNXg
+    // 폜͖̗vfŌ𖄂߂̂ŃIuWFNg̃AhX͕ς
+    // O璷QƂƂ̓|C^ł͂Ȃ handle 
+    //
+    // T  bool update() `, false Ԃƍ폜
+    // (ctor/dtor/draw  tasklist Ɠ)
+    //
+    // Storage  fixed_storage  chunked_storage
+    template<class T, class Storage>
+    class basic_dense_tasklist{
+    public:
+        using value_type = T;
+
+        // t̎Q. wĂIuWFNg get  nullptr Ԃ
+        struct handle{
+            std::uint32_t slot = 0;
+            std::uint32_t generation = 0;
+        };
+
+        basic_dense_tasklist(){
+            init_slots(0);
+        }
+
+        // ^XN𐶐. tő₹Ȃ nullptr Ԃ, drops 𐔂
+        // Ԃ|C^͎ɍ폜N܂ŗL
+        T *create_task(){
+            if(size_ == storage_.capacity()){
+                std::size_t old = storage_.capacity();
+                if(!storage_.grow()){
+                    ++drops_;
+                    return nullptr;
+                }
+                init_slots(old);
+            }
+            std::uint32_t slot = storage_.free_slot(--free_num_);
+            storage_.slot(slot).index = static_cast<std::uint32_t>(size_);
+            storage_.slot_of(size_) = slot;
+            T *p = &storage_.item(size_++);
+            ++spawned_;
+            high_water_ = std::max(high_water_, size_);
+            p->ctor();
+            return p;
+        }
+
+        // ^XN폜 (update/remove_if ̒͌Ă΂Ȃ)
+        void delete_task(T *p){
+            remove_at(storage_.index_of(p));
+        }
+
+        handle get_handle(const T *p){
+            handle h;
+            h.slot = storage_.slot_of(storage_.index_of(p));
+            h.generation = storage_.slot(h.slot).generation;
+            return h;
+        }
+
+        // h ̎wIuWFNg. ɍ폜Ă nullptr
+        T *get(handle h){
+            if(h.slot >= storage_.capacity() || storage_.slot(h.slot).generation != h.generation || storage_.slot(h.slot).index >= size_){
+                return nullptr;
+            }
+            return &storage_.item(storage_.slot(h.slot).index);
+        }
+
+        // NA (mۂubNƌvl͂̂܂)
+        void clear(){
+            while(size_ > 0){
+                remove_at(size_ - 1);
+            }
+        }
+
+        bool empty() const{
+            return size_ == 0;
+        }
+
+        std::size_t size() const{
+            return size_;
+        }
+
+        pool_stats stats() const{
+            pool_stats s;
+            s.size = size_;
+            s.capacity = storage_.capacity();
+            s.limit = storage_.limit();
+            s.high_water = high_water_;
+            s.spawned = spawned_;
+            s.drops = drops_;
+            return s;
+        }
+
+        // high_water ̐, spawned  drops  0 ɖ߂
+        void reset_stats(){
+            high_water_ = size_;
+            spawned_ = drops_ = 0;
+        }
+
+        // Sč폜ăubN, ȍ~ a  (V[̐؂ւ)
+        // fixed_storage Ȃ clear Ɠ
+        // ͈ȑO handle  get ɓnȂ
+        void release(arena &a){
+            if(Storage::releasable){
+                // ubN item ȂȂ̂Ő dtor Ă
+                for(std::size_t i = 0; i < size_; ++i){
+                    storage_.item(i).dtor();
+                }
+                storage_.release(a);
+                size_ = free_num_ = 0;
+                init_slots(0);
+            }else{
+                // dtor  clear (remove_at) Ă
+                clear();
+            }
+            reset_stats();
+        }
+
+        // ^XN
+        // Sĉ񂵏IĂ false Ԃ̂܂Ƃ߂č폜̂,
+        // update ̒ŕтς邱Ƃ͂Ȃ
+        // update ͑̃Xg𒼐ڐG炸 command_buffer ɗ\
+        void update(){
+            dead_.clear();
+            for(std::size_t i = 0; i < size_; ++i){
+                if(!storage_.item(i).update()){
+                    dead_.push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+            // 납, ߂ɗ閖̗vf͏ɐĂ
+            for(std::size_t i = dead_.size(); i-- > 0;){
+                remove_at(dead_[i]);
+            }
+        }
+
+        // 1 grain ȏɕ jobs ŕɉ
+        //  k ̒ update  jobs::partition() == k ŌĂ΂
+        // command_buffer ̗\͋ԂƂɗ߂ĔԍɂȂ̂, 1Xbhŉ񂵂ƂƓɂȂ
+        void update(jobs::scheduler &s, std::size_t grain){
+            const std::size_t parts = jobs::partitions(size_, grain);
+            if(parts <= 1){
+                update();
+                return;
+            }
+            if(dead_parts_.size() < parts){
+                dead_parts_.resize(parts);
+            }
+            const std::size_t n = size_, step = (n + parts - 1) / parts;
+            s.parallel_for(parts, [&](std::size_t k){
+                std::vector<std::uint32_t> &dead = dead_parts_[k];
+                dead.clear();
+                const std::size_t last = std::min(n, (k + 1) * step);
+                for(std::size_t i = k * step; i < last; ++i){
+                    if(!storage_.item(i).update()){
+                        dead.push_back(static_cast<std::uint32_t>(i));
+                    }
+                }
+            });
+            for(std::size_t k = parts; k-- > 0;){
+                const std::vector<std::uint32_t> &dead = dead_parts_[k];
+                for(std::size_t i = dead.size(); i-- > 0;){
+                    remove_at(dead[i]);
+                }
+            }
+        }
+
+        // pred(T&)  true Ԃ̂폜
+        template<class Pred>
+        void remove_if(Pred pred){
+            for(std::size_t i = size_; i-- > 0;){
+                if(pred(storage_.item(i))){
+                    remove_at(i);
+                }
+            }
+        }
+
+        // `^XN
+        void draw() const{
+            for(std::size_t i = size_; i-- > 0;){
+                storage_.item(i).draw();
+            }
+        }
+
+    private:
+        static const std::uint32_t no_index = ~std::uint32_t(0);
+
+        // first ȍ~̑̃Xbg󂫂ɂ
+        // Ⴂԍg悤ɐς
+        void init_slots(std::size_t first){
+            const std::size_t last = storage_.capacity();
+            for(std::size_t i = last; i-- > first;){
+                storage_.slot(i).index = no_index;
+                storage_.slot(i).generation = 1;
+                storage_.free_slot(free_num_++) = static_cast<std::uint32_t>(i);
+            }
+        }
+
+        void remove_at(std::size_t i){
+            storage_.item(i).dtor();
+            std::uint32_t slot = storage_.slot_of(i);
+            ++storage_.slot(slot).generation;
+            storage_.slot(slot).index = no_index;
+            storage_.free_slot(free_num_++) = slot;
+
+            // Ō𖄂߂
+            std::size_t last = --size_;
+            if(i != last){
+                storage_.item(i) = storage_.item(last);
+                storage_.slot_of(i) = storage_.slot_of(last);
+                storage_.slot(storage_.slot_of(i)).index = static_cast<std::uint32_t>(i);
+            }
+        }
+
+        Storage storage_;
+        std::size_t size_ = 0;
+        std::size_t free_num_ = 0;
+        std::size_t high_water_ = 0;
+        std::size_t spawned_ = 0;
+        std::size_t drops_ = 0;
+
+        // update ō폜̂̈ʒu (t[g)
+        std::vector<std::uint32_t> dead_;
+        std::vector<std::vector<std::uint32_t>> dead_parts_;
+    };
+
+    // ő N ̌Œ蒷
+    template<class T, std::size_t N>
+    using dense_tasklist = basic_dense_tasklist<T, fixed_storage<T, N>>;
+
+    // ChunkSize . Limit  0 łȂ΂Ŏ~܂
+    template<class T, std::size_t ChunkSize, std::size_t Limit = 0>
+    using chunked_tasklist = basic_dense_tasklist<T, chunked_storage<T, ChunkSize, Limit>>;
+
+    // List (dense_tasklist/chunked_tasklist) ɑ΂鐶ƍ폜̗\
+    // 񂵂ĂŒ̃Xg⑼̃Xg𒼐ڏɂ֐ς,
+    // Xg񂵏IĂ apply ł܂Ƃ߂Ĕf
+    // \ jobs::partition() Ƃɕė߂̂, ɉ񂵂Ă update 珑Ă悢
+    template<class List>
+    class command_buffer{
+    public:
+        using value_type = typename List::value_type;
+        using handle = typename List::handle;
+
+        // \񂵂, ctor ς܂gԂ
+        // 񂾒l apply ŐIuWFNgɂ̂܂܎ʂ
+        value_type &spawn(){
+            std::vector<value_type> &spawns = lanes_[jobs::partition()].spawns;
+            spawns.emplace_back();
+            spawns.back().ctor();
+            return spawns.back();
+        }
+
+        // 폜\񂷂. apply ܂łɏĂΉȂ
+        void kill(handle h){
+            lanes_[jobs::partition()].kills.push_back(h);
+        }
+
+        bool empty() const{
+            for(const lane &l : lanes_){
+                if(!l.spawns.empty() || !l.kills.empty()){
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // SĂ̍폜, SĂ̐̏, ꂼԂ̔ԍ, \񂵂Ŕfċɂ
+        // tŐłȂ list  drops ɐ
+        void apply(List &list){
+            for(const lane &l : lanes_){
+                for(const handle &h : l.kills){
+                    if(value_type *p = list.get(h)){
+                        list.delete_task(p);
+                    }
+                }
+            }
+            for(const lane &l : lanes_){
+                for(const value_type &v : l.spawns){
+                    if(value_type *p = list.create_task()){
+                        *p = v;
+                    }
+                }
+            }
+            clear();
+        }
+
+        // fɎ̂Ă
+        void clear(){
+            for(lane &l : lanes_){
+                l.spawns.clear();
+                l.kills.clear();
+            }
+        }
+
+    private:
+        struct lane{
+            std::vector<value_type> spawns;
+            std::vector<handle> kills;
+        };
+
+        std::array<lane, jobs::max_partitions> lanes_;
+    };
+
+    // ^XNXg, ւ̐/폜̗\܂Ƃ߂
+    // 1 Grain ȏɕĕɉ
+    template<class List, std::size_t Grain>
+    struct task_pool{
+        List list;
+        command_buffer<List> commands;
+
+        // Oɉ񂵂ނ̗\𔽉fĂ
+        void update(jobs::scheduler &s){
+            commands.apply(list);
+            list.update(s, Grain);
+        }
+
+        void draw() const{
+            list.draw();
+        }
+
+        void clear(){
+            commands.clear();
+            list.clear();
+        }
+
+        void release(arena &a){
+            commands.clear();
+            list.release(a);
+        }
+
+        pool_stats stats() const{
+            return list.stats();
+        }
+    };
+
+    // world ̎ނƂ̋L^
+    struct type_stats{
+        // T::name()
+        const char *name;
+
+        pool_stats pool;
+
+        // ߂ update/draw ɂ (b)
+        double update_seconds;
+        double draw_seconds;
+    };
+
+    // IuWFNg̎ Types... ̓ꕨ (T::pool_type) SĒڃoɎ,
+    // update/clear/draw  Types ̏ɉ
+    // T::pool_type  update(jobs::scheduler&), draw() const, clear(), release(arena&), stats() const 
+    // T  static const char *name() 
+    //
+    // ނƂ update/draw ̎Ԃ𑪂, stats Ńv[̏Ԃƈꏏɓǂ߂
+    template<class... Types>
+    class world{
+    public:
+        static const std::size_t type_num = sizeof...(Types);
+        using stats_type = std::array<type_stats, type_num>;
+
+        world(){
+            update_seconds_.fill(0.0);
+            draw_seconds_.fill(0.0);
+        }
+
+        template<class T>
+        typename T::pool_type &get(){
+            return std::get<typename T::pool_type>(pools_);
+        }
+
+        template<class T>
+        const typename T::pool_type &get() const{
+            return std::get<typename T::pool_type>(pools_);
+        }
+
+        // VS2015 ł fold gȂ̂, z̏̒ō珇ɓWJ
+        void update(jobs::scheduler &s){
+            using expand = int[];
+            std::size_t i = 0;
+            (void)expand{ 0, (update_one<Types>(s, i++), 0)... };
+            ++frame_;
+        }
+
+        void draw() const{
+            using expand = int[];
+            std::size_t i = 0;
+            (void)expand{ 0, (draw_one<Types>(i++), 0)... };
+        }
+
+        // T ` (Ԃɑ̂̂ނƂ)
+        template<class T>
+        void draw() const{
+            draw_one<T>(index_of<T>());
+        }
+
+        void clear(){
+            using expand = int[];
+            (void)expand{ 0, (get<Types>().clear(), 0)... };
+        }
+
+        // SĎ̂Ăă, ȍ~ a 
+        // L^ 0 ɖ߂
+        void release(arena &a){
+            using expand = int[];
+            (void)expand{ 0, (get<Types>().release(a), 0)... };
+            update_seconds_.fill(0.0);
+            draw_seconds_.fill(0.0);
+            frame_ = 0;
+        }
+
+        // release Ă update Ă񂾉
+        std::uint64_t frame() const{
+            return frame_;
+        }
+
+        // ނƂ̋L^ (Types ̏)
+        stats_type stats() const{
+            stats_type r;
+            std::size_t i = 0;
+            using expand = int[];
+            (void)expand{ 0, (r[i] = make_stats<Types>(i), ++i, 0)... };
+            return r;
+        }
+
+        //-------- CSV
+        // 1sڂ̌o. frame ̌ɎނƂ
+        // alive, capacity, peak, spawned, dropped (spawned/dropped  release ̗݌v), update_ms, draw_ms
+        void write_csv_header(std::ostream &os) const{
+            os << "frame";
+            for(const type_stats &t : stats()){
+                for(const char *column : { "alive", "capacity", "peak", "spawned", "dropped", "update_ms", "draw_ms" }){
+                    os << ',' << t.name << '.' << column;
+                }
+            }
+            os << '\n';
+        }
+
+        // ̃t[1s
+        void write_csv(std::ostream &os) const{
+            os << frame_;
+            for(const type_stats &t : stats()){
+                os << ',' << t.pool.size << ',' << t.pool.capacity << ',' << t.pool.high_water
+                    << ',' << t.pool.spawned << ',' << t.pool.drops
+                    << ',' << t.update_seconds * 1000.0 << ',' << t.draw_seconds * 1000.0;
+            }
+            os << '\n';
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        template<class T>
+        void update_one(jobs::scheduler &s, std::size_t i){
+            const clock::time_point begin = clock::now();
+            get<T>().update(s);
+            update_seconds_[i] = std::chrono::duration<double>(clock::now() - begin).count();
+        }
+
+        template<class T>
+        void draw_one(std::size_t i) const{
+            const clock::time_point begin = clock::now();
+            get<T>().draw();
+            draw_seconds_[i] = std::chrono::duration<double>(clock::now() - begin).count();
+        }
+
+        template<class T>
+        static std::size_t index_of(){
+            const bool match[] = { std::is_same<T, Types>::value... };
+            std::size_t i = 0;
+            while(!match[i]){
+                ++i;
+            }
+            return i;
+        }
+
+        template<class T>
+        type_stats make_stats(std::size_t i) const{
+            type_stats t;
+            t.name = T::name();
+            t.pool = get<T>().stats();
+            t.update_seconds = update_seconds_[i];
+            t.draw_seconds = draw_seconds_[i];
+            return t;
+        }
+
+        std::tuple<typename Types::pool_type...> pools_;
+        std::array<double, type_num> update_seconds_;
+        mutable std::array<double, type_num> draw_seconds_;
+        std::uint64_t frame_ = 0;
+    };
+}
@@ -0,0 +1,195 @@
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include "thread_config.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#include <avrt.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace thread_config{
+    namespace{
+        const int role_num = static_cast<int>(role::num);
+
+        // I[fBIR[obNǂݏ̂ŃbNgȂ
+        // 萔ŏ, ÓIȏ̑Oɕʂ̃Xbhǂ܂Ă̒l悤ɂ
+        // (l settings ̊Ɠ)
+        struct shared_settings{
+            constexpr shared_settings() : realtime(false), priority(50), core(-1){}
+
+            std::atomic<bool> realtime;
+            std::atomic<int> priority, core;
+        };
+
+        // apply_current_thread ̌
+        // ͍炸ɃG[R[h, last_result œǂނƂɕ͂ɂ
+        // ݒ seq ɂȂ
+        struct shared_result{
+            std::atomic<unsigned> seq;
+            std::atomic<bool> applied, realtime_requested, realtime, pin_requested, pinned;
+            std::atomic<int> realtime_error, pin_error, core;
+        };
+
+        shared_settings configs[role_num];
+        shared_result results[role_num];
+
+#ifdef _WIN32
+        // MMCSS ̃^XN
+        const wchar_t *mmcss_task(role r){
+            return r == role::audio ? L"Pro Audio" : L"Audio";
+        }
+#endif
+    }
+
+    void configure(role r, const settings &s){
+        // apply_current_thread ŌĂԑOɂŐĂ
+        core_count();
+        shared_settings &c = configs[static_cast<int>(r)];
+        c.realtime.store(s.realtime, std::memory_order_relaxed);
+        c.priority.store(s.priority, std::memory_order_relaxed);
+        c.core.store(s.core, std::memory_order_release);
+    }
+
+    settings configuration(role r){
+        const shared_settings &c = configs[static_cast<int>(r)];
+        settings s;
+        s.core = c.core.load(std::memory_order_acquire);
+        s.realtime = c.realtime.load(std::memory_order_relaxed);
+        s.priority = c.priority.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void apply_current_thread(role r){
+        const settings s = configuration(r);
+        bool realtime = false, pinned = false;
+        int realtime_error = 0, pin_error = 0;
+
+#ifdef _WIN32
+        if(s.realtime){
+            // nh̓XbhI܂ŎĂ (OSɔC)
+            DWORD task_index = 0;
+            if(AvSetMmThreadCharacteristicsW(mmcss_task(r), &task_index)){
+                realtime = true;
+            }else{
+                realtime_error = static_cast<int>(GetLastError());
+            }
+        }
+        if(s.core >= 0){
+            if(s.core < core_count() && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << s.core) != 0){
+                pinned = true;
+            }else{
+                pin_error = s.core < core_count() ? static_cast<int>(GetLastError()) : 0;
+            }
+        }
+#else
+        if(s.realtime){
+            sched_param param;
+            std::memset(&param, 0, sizeof(param));
+            param.sched_priority = s.priority;
+            realtime_error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+            realtime = realtime_error == 0;
+        }
+        if(s.core >= 0){
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(s.core, &set);
+            pin_error = s.core < core_count() ? pthread_setaffinity_np(pthread_self(), sizeof(set), &set) : EINVAL;
+            pinned = pin_error == 0;
+        }
+#endif
+
+        shared_result &res = results[static_cast<int>(r)];
+        res.seq.fetch_add(1, std::memory_order_acq_rel);
+        res.applied.store(true, std::memory_order_relaxed);
+        res.realtime_requested.store(s.realtime, std::memory_order_relaxed);
+        res.realtime.store(realtime, std::memory_order_relaxed);
+        res.realtime_error.store(realtime_error, std::memory_order_relaxed);
+        res.pin_requested.store(s.core >= 0, std::memory_order_relaxed);
+        res.pinned.store(pinned, std::memory_order_relaxed);
+        res.pin_error.store(pin_error, std::memory_order_relaxed);
+        res.core.store(s.core, std::memory_order_relaxed);
+        res.seq.fetch_add(1, std::memory_order_release);
+    }
+
+    result apply(role r){
+        apply_current_thread(r);
+        return last_result(r);
+    }
+
+    result last_result(role r){
+        const shared_result &src = results[static_cast<int>(r)];
+        bool applied, realtime_requested, realtime, pin_requested, pinned;
+        int realtime_error, pin_error, core;
+        for(;;){
+            unsigned seq = src.seq.load(std::memory_order_acquire);
+            if(seq & 1){
+                std::this_thread::yield();
+                continue;
+            }
+            applied = src.applied.load(std::memory_order_relaxed);
+            realtime_requested = src.realtime_requested.load(std::memory_order_relaxed);
+            realtime = src.realtime.load(std::memory_order_relaxed);
+            realtime_error = src.realtime_error.load(std::memory_order_relaxed);
+            pin_requested = src.pin_requested.load(std::memory_order_relaxed);
+            pinned = src.pinned.load(std::memory_order_relaxed);
+            pin_error = src.pin_error.load(std::memory_order_relaxed);
+            core = src.core.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(src.seq.load(std::memory_order_relaxed) == seq){
+                break;
+            }
+        }
+
+        result res;
+        res.applied = applied;
+        res.realtime = realtime;
+        res.pinned = pinned;
+        auto deny = [&res](const std::string &m){
+            if(!res.message.empty()){
+                res.message += "; ";
+            }
+            res.message += m;
+        };
+#ifdef _WIN32
+        if(realtime_requested && !realtime){
+            deny("MMCSS denied (error " + std::to_string(realtime_error) + ")");
+        }
+        if(pin_requested && !pinned){
+            deny("affinity to core " + std::to_string(core) + " denied" + (pin_error != 0 ? " (error " + std::to_string(pin_error) + ")" : std::string()));
+        }
+#else
+        if(realtime_requested && !realtime){
+            // EPERM Ȃ RLIMIT_RTPRIO  CAP_SYS_NICE v̂, ̎|\
+            deny(std::string("SCHED_FIFO denied (") + std::strerror(realtime_error)
+                + (realtime_error == EPERM ? "; needs RLIMIT_RTPRIO or CAP_SYS_NICE" : "") + ")");
+        }
+        if(pin_requested && !pinned){
+            deny("affinity to core " + std::to_string(core) + " denied (" + std::strerror(pin_error) + ")");
+        }
+#endif
+        return res;
+    }
+
+    int core_count(){
+        int n = static_cast<int>(std::thread::hardware_concurrency());
+        return n > 0 ? n : 1;
+    }
+
+    const char *name(role r){
+        switch(r){
+        case role::audio:
+            return "audio";
+        case role::worker:
+            return "worker";
+        case role::game:
+            return "game";
+        default:
+            return "";
+        }
+    }
+}
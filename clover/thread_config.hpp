@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+
+//-------- Xbh̗DxƃRÅ蓖
+// I[fBI֌W̃XbhA^CDxɏグ, Q[̃XbhƂ͕ʂ̃RAɒu
+// Windows ł MMCSS, Linux ł SCHED_FIFO g
+// fĂ̂܂ܓ, R last_result œǂ߂悤ɂĂ
+namespace thread_config{
+    enum class role{
+        // I[fBIR[obN (~LT[, )
+        audio,
+        // Ȃ̓ǂݍ݂ƍĐZbV
+        worker,
+        // Q[[vƕ`
+        game,
+        num
+    };
+
+    struct settings{
+        // A^CDxɏグ
+        bool realtime = false;
+
+        // SCHED_FIFO ̗Dx (Linux, 1  99)
+        // Windows ł MMCSS ̃^XN̊ɔC
+        int priority = 50;
+
+        // uRA (Ȃuꏊ߂Ȃ)
+        int core = -1;
+    };
+
+    struct result{
+        // Kp
+        bool applied = false;
+        // A^CDxɏオ
+        bool realtime = false;
+        // RAɒu
+        bool pinned = false;
+        // fꂽR (SĒʂ)
+        std::string message;
+    };
+
+    // role ̃Xbhgݒ (XbhOɌĂ)
+    // settings ̊ς thread_config.cpp  shared_settings 킹
+    void configure(role r, const settings &s);
+    settings configuration(role r);
+
+    // Ă񂾃Xbh role ̐ݒKpČʂL^
+    // OS ĂԂŃbN̊mۂȂ̂, I[fBIR[obN͂Ă
+    // ʂ͂̕ last_result œǂނƂɍ
+    void apply_current_thread(role r);
+
+    // apply_current_thread ČʂԂ (I[fBIR[obN͌Ă΂Ȃ)
+    result apply(role r);
+
+    // Ō apply 
+    result last_result(role r);
+
+    // gRA̐
+    int core_count();
+
+    const char *name(role r);
+}
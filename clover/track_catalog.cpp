@@ -0,0 +1,225 @@
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <unordered_map>
+#include <boost/filesystem.hpp>
+#include "audioprobe.h"
+#include "track_catalog.hpp"
+
+namespace track_catalog{
+    //-------- t@C`
+    // header, record * count, pX (NULI[) ̏ɕׂ
+    namespace{
+        const char magic[4] = { 'C', 'T', 'L', 'G' };
+        const std::uint32_t version = 1;
+
+        struct header{
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t count;
+            std::uint32_t string_bytes;
+        };
+
+        struct record{
+            std::int64_t num_frames;
+            std::int64_t file_size;
+            std::int64_t write_time;
+            // ̈̒ł̃pẌʒu
+            std::uint32_t path_offset;
+            std::uint32_t sample_rate;
+            std::uint16_t channels;
+            std::uint8_t format;
+            std::uint8_t exact;
+            std::uint16_t bitrate;
+            std::uint16_t reserved;
+        };
+
+        static_assert(sizeof(record) == 40, "catalog record must stay 40 bytes");
+
+        const char *const extensions[] = { ".wav", ".wave", ".mp3", ".m4a", ".mp4" };
+    }
+
+    bool is_track(const std::string &path){
+        std::string ext = boost::filesystem::path(path).extension().string();
+        for(auto &c : ext){
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return std::find(std::begin(extensions), std::end(extensions), ext) != std::end(extensions);
+    }
+
+    std::vector<entry> scan(const std::string &dir, const std::vector<entry> &previous, int threads, scan_stats *stats){
+        auto begin = std::chrono::steady_clock::now();
+
+        // Ȃ̈ꗗ
+        std::vector<std::string> paths;
+        boost::system::error_code ec;
+        for(boost::filesystem::recursive_directory_iterator it(dir, ec), last; it != last; it.increment(ec)){
+            if(ec){
+                break;
+            }
+            if(boost::filesystem::is_regular_file(it->path(), ec) && is_track(it->path().string())){
+                paths.push_back(it->path().string());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+
+        std::unordered_map<std::string, const entry*> known;
+        for(const entry &e : previous){
+            known[e.path] = &e;
+        }
+
+        // 1Ȃ荇ēǂ
+        // eXbh͎Y̗vfɂ
+        std::vector<entry> result(paths.size());
+        std::vector<char> ok(paths.size(), 0);
+        std::atomic<std::size_t> next(0), probed(0), reused(0);
+        auto worker = [&](){
+            for(std::size_t i = next++; i < paths.size(); i = next++){
+                entry &e = result[i];
+                e.path = paths[i];
+                boost::system::error_code err;
+                e.file_size = static_cast<long long>(boost::filesystem::file_size(e.path, err));
+                if(err){
+                    continue;
+                }
+                e.write_time = static_cast<long long>(boost::filesystem::last_write_time(e.path, err));
+                if(err){
+                    continue;
+                }
+
+                auto k = known.find(e.path);
+                if(k != known.end() && k->second->file_size == e.file_size && k->second->write_time == e.write_time){
+                    e = *k->second;
+                    ok[i] = 1;
+                    ++reused;
+                    continue;
+                }
+
+                AudioProbeInfo info;
+                ++probed;
+                if(!AudioProbe::probe(e.path, &info)){
+                    continue;
+                }
+                e.num_frames = info.numFrames;
+                e.sample_rate = info.sampleRate;
+                e.channels = info.channels;
+                e.bitrate = info.bitrate;
+                e.format = info.format;
+                e.exact = info.exact;
+                ok[i] = 1;
+            }
+        };
+
+        threads = std::max(1, std::min(threads, static_cast<int>(paths.size())));
+        std::vector<std::thread> pool;
+        for(int i = 1; i < threads; ++i){
+            pool.emplace_back(worker);
+        }
+        worker();
+        for(auto &t : pool){
+            t.join();
+        }
+
+        std::vector<entry> entries;
+        entries.reserve(paths.size());
+        for(std::size_t i = 0; i < paths.size(); ++i){
+            if(ok[i]){
+                entries.push_back(std::move(result[i]));
+            }
+        }
+
+        if(stats){
+            stats->files = paths.size();
+            stats->probed = probed;
+            stats->reused = reused;
+            stats->failed = paths.size() - entries.size();
+            stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+        return entries;
+    }
+
+    bool save(const std::string &path, const std::vector<entry> &entries){
+        std::vector<record> records(entries.size());
+        std::string strings;
+        for(std::size_t i = 0; i < entries.size(); ++i){
+            const entry &e = entries[i];
+            record &r = records[i];
+            std::memset(&r, 0, sizeof(r));
+            r.num_frames = e.num_frames;
+            r.file_size = e.file_size;
+            r.write_time = e.write_time;
+            r.path_offset = static_cast<std::uint32_t>(strings.size());
+            r.sample_rate = static_cast<std::uint32_t>(e.sample_rate);
+            r.channels = static_cast<std::uint16_t>(e.channels);
+            r.format = static_cast<std::uint8_t>(e.format);
+            r.exact = e.exact ? 1 : 0;
+            r.bitrate = static_cast<std::uint16_t>(std::min(e.bitrate, 0xFFFF));
+            strings.append(e.path);
+            strings.push_back('\0');
+        }
+
+        header h;
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = version;
+        h.count = static_cast<std::uint32_t>(records.size());
+        h.string_bytes = static_cast<std::uint32_t>(strings.size());
+
+        // IĂ獷ւ
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream ofs(temp, std::ios::binary | std::ios::trunc);
+            ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            if(!records.empty()){
+                ofs.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(record));
+            }
+            ofs.write(strings.data(), strings.size());
+            if(!ofs){
+                return false;
+            }
+        }
+        boost::system::error_code ec;
+        boost::filesystem::rename(temp, path, ec);
+        return !ec;
+    }
+
+    bool load(const std::string &path, std::vector<entry> &entries){
+        std::ifstream ifs(path, std::ios::binary);
+        header h;
+        if(!ifs.read(reinterpret_cast<char*>(&h), sizeof(h)) || std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version){
+            return false;
+        }
+        std::vector<record> records(h.count);
+        std::string strings(h.string_bytes, '\0');
+        if(h.count > 0 && !ifs.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(record))){
+            return false;
+        }
+        if(h.string_bytes > 0 && !ifs.read(&strings[0], strings.size())){
+            return false;
+        }
+
+        entries.clear();
+        entries.reserve(records.size());
+        for(const record &r : records){
+            if(r.path_offset >= strings.size()){
+                return false;
+            }
+            entry e;
+            e.path = strings.c_str() + r.path_offset;
+            e.file_size = r.file_size;
+            e.write_time = r.write_time;
+            e.num_frames = r.num_frames;
+            e.sample_rate = static_cast<int>(r.sample_rate);
+            e.channels = r.channels;
+            e.bitrate = r.bitrate;
+            e.format = r.format;
+            e.exact = r.exact != 0;
+            entries.push_back(std::move(e));
+        }
+        return true;
+    }
+}
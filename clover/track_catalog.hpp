@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//-------- ȃCũJ^O
+// fBNgȉ̋Ȃwb_ǂ (AudioProbe) `ƒW,
+// ȃoCit@Cɕۑ
+// fR[_JȂ̂ŐȂłɏI
+namespace track_catalog{
+    struct entry{
+        // t@C̃pX
+        std::string path;
+
+        // ύX̌op
+        long long file_size;
+        long long write_time;
+
+        // AudioProbeInfo ̓e
+        long long num_frames;
+        int sample_rate;
+        int channels;
+        int bitrate;
+        int format;
+        bool exact;
+    };
+
+    struct scan_stats{
+        // Ȃ̐
+        std::size_t files = 0;
+        // wb_ǂ񂾋Ȃ̐
+        std::size_t probed = 0;
+        // ÕJ^Og񂵂Ȃ̐
+        std::size_t reused = 0;
+        // ǂ߂ȂȂ̐
+        std::size_t failed = 0;
+        //  (b)
+        double seconds = 0.0;
+    };
+
+    // J^Oɍڂgq
+    bool is_track(const std::string &path);
+
+    // dir ȉ threads {̃XbhŃXL
+    // previous ɓpX/TCY/XV̂̂΃wb_ǂ܂ɂg
+    // ʂ̓pX
+    std::vector<entry> scan(const std::string &dir, const std::vector<entry> &previous, int threads, scan_stats *stats = nullptr);
+
+    bool save(const std::string &path, const std::vector<entry> &entries);
+    bool load(const std::string &path, std::vector<entry> &entries);
+}
@@ -0,0 +1,240 @@
+//-------- ȃCüꊇ
+// fBNgȉ̋ȂSẴRAŕɃfR[h/͂,
+// ȂƂɃXyNgƗオ̃LbV (spectrum::cache_path) 
+// ȂςĂȂ΃LbV͂̂܂܎g
+// Q[ƓXg[̃Tv[gɕϊĂ͂
+// Q[͏o̓foCX̃Tv[gƓLbVg, ႦΎԂŉ͂
+//
+// ́uXbh x 1ubNvgȂ (ȑŜǂݍ܂Ȃ)
+//
+// g : analyze <fBNg> [Xbh] [Tv[g ( 48000)]
+//
+// rh (Linux, WAVÊ) :
+//   g++ -std=c++14 -O2 -I../clover analyze.cpp ../clover/spectrum.cpp ../clover/track_catalog.cpp ../clover/audioprobe.cpp ../clover/audiodecoderbase.cpp ../clover/audiodecoderwave.cpp -lboost_filesystem -lboost_system -lpthread -o analyze
+// rh (Windows) :
+//   cl /O2 /EHsc /I..\clover analyze.cpp ..\clover\spectrum.cpp ..\clover\track_catalog.cpp ..\clover\audioprobe.cpp ..\clover\audiodecoderbase.cpp ..\clover\audiodecoderwave.cpp ..\clover\audiodecodermediafoundation.cpp ..\clover\audiodecoderpcmcache.cpp mfplat.lib mfreadwrite.lib mfuuid.lib propsys.lib ole32.lib
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include "spectrum.hpp"
+#include "resampler.hpp"
+#include "track_catalog.hpp"
+#include "audiodecoderwave.h"
+#ifdef _WIN32
+#include "audiodecoder.h"
+#endif
+
+namespace analyze{
+    std::unique_ptr<AudioDecoderBase> open_decoder(const std::string &path){
+        std::unique_ptr<AudioDecoderBase> decoder;
+        std::string ext = boost::filesystem::path(path).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](char c){ return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        if(ext == ".wav" || ext == ".wave"){
+            decoder.reset(new AudioDecoderWave(path));
+        }else{
+#ifdef _WIN32
+            decoder.reset(new AudioDecoder(path));
+#else
+            return nullptr;
+#endif
+        }
+        if(decoder->open() != AUDIODECODER_OK || decoder->channels() <= 0){
+            return nullptr;
+        }
+        return decoder;
+    }
+
+    // LbVȂƈvĂ邩
+    bool up_to_date(const std::string &track, long long size, long long time, int rate){
+        std::ifstream ifs(spectrum::cache_path(track), std::ios::binary);
+        spectrum::cache_header h;
+        return ifs.read(reinterpret_cast<char*>(&h), sizeof(h))
+            && std::memcmp(h.magic, spectrum::cache_magic, sizeof(h.magic)) == 0
+            && h.version == spectrum::cache_version
+            && h.sample_rate == static_cast<std::uint32_t>(rate)
+            && h.track_size == size && h.track_time == time;
+    }
+
+    // 1ȉ͂ăLbV. ͂Ȃ̒ (b) Ԃ. s畉
+    // rate ̓Xg[̃Tv[g. ĐƓTvʂĂ͂
+    double run(const std::string &track, long long size, long long time, int rate){
+        std::unique_ptr<AudioDecoderBase> decoder = open_decoder(track);
+        if(!decoder){
+            return -1.0;
+        }
+
+        // Q[Ɠő2`l܂ŉ͂
+        const int channels = decoder->channels();
+        const int analysed = std::min(channels, 2);
+
+        spectrum::cache_header h;
+        std::memcpy(h.magic, spectrum::cache_magic, sizeof(h.magic));
+        h.version = spectrum::cache_version;
+        h.channels = analysed;
+        h.sample_rate = rate;
+        h.block_frames = spectrum::block_frames;
+        h.bands = spectrum::bands;
+        h.blocks = 0;
+        h.track_size = size;
+        h.track_time = time;
+
+        std::string temp = spectrum::cache_path(track) + ".tmp";
+        std::ofstream ofs(temp, std::ios::binary | std::ios::trunc);
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+        std::vector<SAMPLE> block(spectrum::block_frames * channels);
+        std::vector<float> band(analysed * spectrum::bands), prev(analysed * spectrum::bands, 0.0f);
+        std::vector<std::uint16_t> packed(analysed * spectrum::bands);
+        std::vector<float> onset(analysed);
+        spectrum::analyzer analyzer;
+
+        // Tv[gႦ΍Đ (playlist::track) Ɠiŕϊ
+        std::unique_ptr<resampler::polyphase> r;
+        if(rate != decoder->sampleRate()){
+            r.reset(new resampler::polyphase(channels, decoder->sampleRate(), rate, resampler::quality::medium));
+        }
+        auto read_stream = [&](float *out, int n) -> std::size_t{
+            if(!r){
+                return decoder->readFrames(out, n);
+            }
+            return r->pull(out, n, [&](float *buffer, int m){
+                return static_cast<int>(decoder->readFrames(buffer, m));
+            });
+        };
+
+        std::size_t frames = 0;
+        for(;;){
+            std::size_t n = read_stream(block.data(), spectrum::block_frames);
+            if(n == 0){
+                break;
+            }
+            frames += n;
+            // Ō̔[ȃubN͖Ŗ߂
+            std::fill(block.begin() + n * channels, block.end(), 0.0f);
+
+            for(int ch = 0; ch < analysed; ++ch){
+                float *b = &band[ch * spectrum::bands];
+                analyzer.run(block.data(), channels, ch, b);
+                onset[ch] = spectrum::onset(&prev[ch * spectrum::bands], b);
+                for(int i = 0; i < spectrum::bands; ++i){
+                    packed[ch * spectrum::bands + i] = spectrum::encode_band(b[i]);
+                }
+            }
+            ofs.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(packed[0]));
+            ofs.write(reinterpret_cast<const char*>(onset.data()), onset.size() * sizeof(onset[0]));
+            band.swap(prev);
+            ++h.blocks;
+            if(n < static_cast<std::size_t>(spectrum::block_frames)){
+                break;
+            }
+        }
+
+        ofs.seekp(0);
+        ofs.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        ofs.close();
+        boost::system::error_code ec;
+        if(!ofs || h.blocks == 0){
+            boost::filesystem::remove(temp, ec);
+            return -1.0;
+        }
+        boost::filesystem::rename(temp, spectrum::cache_path(track), ec);
+        if(ec){
+            boost::filesystem::remove(temp, ec);
+            return -1.0;
+        }
+        return static_cast<double>(frames) / rate;
+    }
+}
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        std::cerr << "usage: analyze <directory> [threads] [sample rate]" << std::endl;
+        return 1;
+    }
+    int threads = argc >= 3 ? std::atoi(argv[2]) : static_cast<int>(std::thread::hardware_concurrency());
+    if(threads <= 0){
+        threads = 1;
+    }
+    // Q[̏o̓foCX̃Tv[gɍ킹
+    const int rate = argc >= 4 ? std::atoi(argv[3]) : 48000;
+    if(rate <= 0){
+        std::cerr << "invalid sample rate: " << argv[3] << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> tracks;
+    boost::system::error_code ec;
+    for(boost::filesystem::recursive_directory_iterator it(argv[1], ec), last; it != last; it.increment(ec)){
+        if(ec){
+            break;
+        }
+        if(boost::filesystem::is_regular_file(it->path(), ec) && track_catalog::is_track(it->path().string())){
+            tracks.push_back(it->path().string());
+        }
+    }
+    std::sort(tracks.begin(), tracks.end());
+
+    std::atomic<std::size_t> next(0), done(0), analysed(0), skipped(0), failed(0);
+    std::atomic<long long> audio_ms(0);
+    auto worker = [&](){
+        for(std::size_t i = next++; i < tracks.size(); i = next++){
+            const std::string &track = tracks[i];
+            // Q[LbVm߂ƂƓlg
+            std::int64_t size, time;
+            if(!spectrum::track_stamp(track, &size, &time)){
+                ++failed;
+            }else if(analyze::up_to_date(track, size, time, rate)){
+                ++skipped;
+            }else{
+                double seconds = analyze::run(track, size, time, rate);
+                if(seconds < 0.0){
+                    ++failed;
+                }else{
+                    ++analysed;
+                    audio_ms += static_cast<long long>(seconds * 1000.0);
+                }
+            }
+            ++done;
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(int i = 0; i < threads; ++i){
+        pool.emplace_back(worker);
+    }
+
+    // 1bƂɐi݋o
+    auto report = [&](){
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        double per_minute = elapsed > 0.0 ? analysed * 60.0 / elapsed : 0.0;
+        double realtime = elapsed > 0.0 ? audio_ms / 1000.0 / elapsed : 0.0;
+        std::cout << "\r" << done << "/" << tracks.size() << " tracks  "
+            << std::fixed << std::setprecision(1) << per_minute << " tracks/min  "
+            << realtime << "x realtime" << std::flush;
+    };
+    for(int tick = 1; done < tracks.size(); ++tick){
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if(tick % 10 == 0){
+            report();
+        }
+    }
+    for(auto &t : pool){
+        t.join();
+    }
+    report();
+    std::cout << "\n" << analysed << " analysed, " << skipped << " up to date, " << failed << " failed ("
+        << threads << " threads, " << rate << " Hz)" << std::endl;
+    return failed > 0 ? 2 : 0;
+}
@@ -0,0 +1,279 @@
+//-------- fR[_̃x`}[N
+// fBNgȉ̉t@CSēǂ, fR[_ƌ`Ƃ
+//  EԂɑ΂fR[hx
+//  E1b̃mۉ (operator new ̂ݐ)
+//  EubNTCYƂ read ̃CeV (p[Z^C)
+//  Eseek ̃CeV
+// \. ʂTEhfoCXgȂ
+//
+// g : decoderbench <fBNg> [V[N]
+//
+// rh (Linux, WAVEfR[_̂) :
+//   g++ -std=c++14 -O2 -I../clover decoderbench.cpp ../clover/audiodecoderbase.cpp ../clover/audiodecoderwave.cpp -lboost_filesystem -lboost_system -o decoderbench
+// rh (Windows, Media Foundation v) :
+//   cl /O2 /EHsc /I..\clover decoderbench.cpp ..\clover\audiodecoderbase.cpp ..\clover\audiodecoderwave.cpp ..\clover\audiodecodermediafoundation.cpp ..\clover\audiodecoderpcmcache.cpp mfplat.lib mfreadwrite.lib mfuuid.lib propsys.lib ole32.lib
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <atomic>
+#include <map>
+#include <new>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include <functional>
+#include <boost/filesystem.hpp>
+#include "audiodecoderwave.h"
+#ifdef _WIN32
+#include "audiodecodermediafoundation.h"
+#endif
+
+//-------- mۂ̉񐔂𐔂
+// delete  std::free ƃCCWJ GCC 
+// new  free ̑gݍ킹 -Wmismatched-new-delete Ōx̂,
+// mۂƉ̓CCȂ֐ɂ܂Ƃ߂
+#ifdef _MSC_VER
+#define ALLOC_COUNTER_NOINLINE __declspec(noinline)
+#else
+#define ALLOC_COUNTER_NOINLINE __attribute__((noinline))
+#endif
+
+namespace alloc_counter{
+    std::atomic<unsigned long long> count(0);
+
+    ALLOC_COUNTER_NOINLINE void *allocate(std::size_t size){
+        ++count;
+        void *p = std::malloc(size ? size : 1);
+        if(!p){
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    ALLOC_COUNTER_NOINLINE void release(void *p) noexcept{
+        std::free(p);
+    }
+}
+
+void *operator new(std::size_t size){
+    return alloc_counter::allocate(size);
+}
+
+void *operator new[](std::size_t size){
+    return alloc_counter::allocate(size);
+}
+
+void operator delete(void *p) noexcept{
+    alloc_counter::release(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept{
+    alloc_counter::release(p);
+}
+
+void operator delete[](void *p) noexcept{
+    alloc_counter::release(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept{
+    alloc_counter::release(p);
+}
+
+namespace bench{
+    using clock_type = std::chrono::steady_clock;
+
+    // vfR[_
+    struct backend{
+        std::string name;
+        std::vector<std::string> extensions;
+        std::function<std::unique_ptr<AudioDecoderBase>(const std::string&)> create;
+    };
+
+    std::vector<backend> available_backends(){
+        std::vector<backend> list;
+        list.push_back(backend{
+            "wave",
+            AudioDecoderWave::supportedFileExtensions(),
+            [](const std::string &path){ return std::unique_ptr<AudioDecoderBase>(new AudioDecoderWave(path)); }
+        });
+#ifdef _WIN32
+        list.push_back(backend{
+            "mediafoundation",
+            AudioDecoderMediaFoundation::supportedFileExtensions(),
+            [](const std::string &path){ return std::unique_ptr<AudioDecoderBase>(new AudioDecoderMediaFoundation(path)); }
+        });
+#endif
+        return list;
+    }
+
+    // read ̃CeVvubNTCY (t[)
+    const int block_sizes[] = { 64, 256, 1024, 4096 };
+    const int block_size_num = sizeof(block_sizes) / sizeof(block_sizes[0]);
+
+    // 1t@C1ubNTCY read ̍ő
+    const int max_reads_per_block = 2000;
+
+    // fR[_ƌ`̑gƂ̏Wv
+    struct result{
+        int files = 0;
+        double audio_seconds = 0.0;
+        double decode_seconds = 0.0;
+        unsigned long long allocations = 0;
+        std::vector<double> read_us[block_size_num];
+        std::vector<double> seek_us;
+    };
+
+    double elapsed_us(clock_type::time_point a, clock_type::time_point b){
+        return std::chrono::duration<double, std::micro>(b - a).count();
+    }
+
+    double percentile(std::vector<double> &v, double p){
+        if(v.empty()){
+            return 0.0;
+        }
+        std::size_t i = std::min(v.size() - 1, static_cast<std::size_t>(p * (v.size() - 1) + 0.5));
+        std::nth_element(v.begin(), v.begin() + i, v.end());
+        return v[i];
+    }
+
+    std::string extension_of(const boost::filesystem::path &path){
+        std::string ext = path.extension().string();
+        if(!ext.empty() && ext[0] == '.'){
+            ext.erase(0, 1);
+        }
+        for(auto &c : ext){
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return ext;
+    }
+
+    // 1t@Cv r ɉ
+    bool measure(const backend &b, const std::string &path, int seek_num, result &r){
+        std::unique_ptr<AudioDecoderBase> decoder = b.create(path);
+        if(decoder->open() != AUDIODECODER_OK || decoder->channels() <= 0 || decoder->sampleRate() <= 0){
+            return false;
+        }
+        const int channels = decoder->channels();
+        std::vector<SAMPLE> buffer(block_sizes[block_size_num - 1] * channels);
+
+        // Ō܂ŒʂăfR[h
+        std::size_t frames = 0;
+        unsigned long long alloc_begin = alloc_counter::count.load();
+        clock_type::time_point begin = clock_type::now();
+        for(;;){
+            std::size_t n = decoder->readFrames(buffer.data(), block_sizes[block_size_num - 1]);
+            frames += n;
+            if(n < static_cast<std::size_t>(block_sizes[block_size_num - 1])){
+                break;
+            }
+        }
+        clock_type::time_point end = clock_type::now();
+        r.allocations += alloc_counter::count.load() - alloc_begin;
+        r.decode_seconds += elapsed_us(begin, end) / 1e6;
+        r.audio_seconds += static_cast<double>(frames) / decoder->sampleRate();
+        ++r.files;
+
+        // ubNTCYƂ read ̃CeV
+        for(int k = 0; k < block_size_num; ++k){
+            decoder->seek(0);
+            for(int i = 0; i < max_reads_per_block; ++i){
+                clock_type::time_point t0 = clock_type::now();
+                std::size_t n = decoder->readFrames(buffer.data(), block_sizes[k]);
+                clock_type::time_point t1 = clock_type::now();
+                if(n == 0){
+                    break;
+                }
+                r.read_us[k].push_back(elapsed_us(t0, t1));
+            }
+        }
+
+        // _Ȉʒuւ̃V[N
+        // fR[_ɂĂ͎ۂ̈ړ read ܂Œx点̂ōŏ read ܂Ŋ܂߂Čv
+        if(frames > 0){
+            std::mt19937 random(0x77777777u);
+            std::uniform_int_distribution<std::size_t> dist(0, frames - 1);
+            for(int i = 0; i < seek_num; ++i){
+                int target = static_cast<int>(dist(random) * channels);
+                clock_type::time_point t0 = clock_type::now();
+                decoder->seek(target);
+                decoder->readFrames(buffer.data(), block_sizes[0]);
+                clock_type::time_point t1 = clock_type::now();
+                r.seek_us.push_back(elapsed_us(t0, t1));
+            }
+        }
+        return true;
+    }
+
+    void report(const std::string &name, result &r){
+        std::cout << name << " : " << r.files << " files, " << std::fixed << std::setprecision(1) << r.audio_seconds << " s of audio\n";
+        double speed = r.decode_seconds > 0.0 ? r.audio_seconds / r.decode_seconds : 0.0;
+        double allocs = r.decode_seconds > 0.0 ? r.allocations / r.decode_seconds : 0.0;
+        std::cout << "  decode      " << std::setprecision(1) << speed << "x realtime, " << std::setprecision(0) << allocs << " allocations/s\n";
+        std::cout << std::setprecision(2);
+        for(int k = 0; k < block_size_num; ++k){
+            std::cout << "  read " << std::setw(5) << block_sizes[k] << "  "
+                << "p50 " << std::setw(9) << percentile(r.read_us[k], 0.5) << " us  "
+                << "p90 " << std::setw(9) << percentile(r.read_us[k], 0.9) << " us  "
+                << "p99 " << std::setw(9) << percentile(r.read_us[k], 0.99) << " us  "
+                << "max " << std::setw(9) << percentile(r.read_us[k], 1.0) << " us\n";
+        }
+        std::cout << "  seek        "
+            << "p50 " << std::setw(9) << percentile(r.seek_us, 0.5) << " us  "
+            << "p90 " << std::setw(9) << percentile(r.seek_us, 0.9) << " us  "
+            << "p99 " << std::setw(9) << percentile(r.seek_us, 0.99) << " us  "
+            << "max " << std::setw(9) << percentile(r.seek_us, 1.0) << " us\n";
+    }
+}
+
+int main(int argc, char *argv[]){
+    if(argc < 2){
+        std::cerr << "usage: decoderbench <directory> [seeks per file]" << std::endl;
+        return 1;
+    }
+    const int seek_num = argc >= 3 ? std::max(0, std::atoi(argv[2])) : 32;
+
+    std::vector<boost::filesystem::path> files;
+    boost::system::error_code ec;
+    for(boost::filesystem::recursive_directory_iterator it(argv[1], ec), last; it != last; it.increment(ec)){
+        if(ec){
+            break;
+        }
+        if(boost::filesystem::is_regular_file(it->path())){
+            files.push_back(it->path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    // "fR[_/`" ƂɏWv
+    std::map<std::string, bench::result> results;
+    for(const bench::backend &b : bench::available_backends()){
+        for(const auto &path : files){
+            std::string ext = bench::extension_of(path);
+            if(std::find(b.extensions.begin(), b.extensions.end(), ext) == b.extensions.end()){
+                continue;
+            }
+            bench::result &r = results[b.name + "/" + ext];
+            if(!bench::measure(b, path.string(), seek_num, r)){
+                std::cerr << b.name << ": failed to open " << path.string() << std::endl;
+            }
+        }
+    }
+
+    int reported = 0;
+    for(auto &i : results){
+        if(i.second.files > 0){
+            bench::report(i.first, i.second);
+            ++reported;
+        }
+    }
+    if(reported == 0){
+        std::cerr << "no decodable files in " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+//-------- Ȃ̃ItCĐ
+// Q[ƓĐ̗ (sound.cpp ̍ĐZbV, ~LT[, ) 
+// TEhfoCX̑ audio_output::null_sink / wav_sink ɂȂ,
+// Ԃ҂CPU葬Ȃ̍Ō܂ŉ
+// ͌ʂ̓Q[Ɠ sync_audible_spectrum Ŏ󂯎
+//
+// g : simulate [-o o.wav] [-r Tv[g] <>...
+//
+// rh (Linux, WAVÊ) :
+//   g++ -std=c++14 -O2 -I../clover simulate.cpp ../clover/sound.cpp ../clover/audio_session.cpp ../clover/playlist.cpp ../clover/mixer.cpp ../clover/audio_output.cpp ../clover/spectrum.cpp ../clover/audiodecoderbase.cpp ../clover/audiodecoderwave.cpp ../clover/thread_config.cpp -lpthread -o simulate
+// rh (Windows) :
+//   cl /O2 /EHsc /I..\clover simulate.cpp ..\clover\sound.cpp ..\clover\audio_session.cpp ..\clover\playlist.cpp ..\clover\mixer.cpp ..\clover\audio_output.cpp ..\clover\spectrum.cpp ..\clover\audiodecoderbase.cpp ..\clover\audiodecoderwave.cpp ..\clover\audiodecodermediafoundation.cpp ..\clover\audiodecoderpcmcache.cpp ..\clover\thread_config.cpp mfplat.lib mfreadwrite.lib mfuuid.lib propsys.lib ole32.lib avrt.lib
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include "playlist.hpp"
+#include "mixer.hpp"
+#include "audio_output.hpp"
+
+//-------- sound.cpp QƂQ[̕ϐ
+std::atomic<bool> is_running(true);
+std::atomic<float> progress;
+
+namespace sound_effect{
+    mixer::clip hit;
+    int hit_interval = 0;
+    extern const int hit_interval_frames;
+    const int hit_interval_frames = 4;
+}
+
+namespace object{
+    volatile float peek_spectrum[2][256];
+}
+
+namespace clover_system{
+    playlist::engine music;
+    mixer::engine audio;
+}
+
+void play_sound(std::vector<std::string> paths);
+bool take_playback_failure();
+void shutdown_sound();
+int sync_audible_spectrum();
+
+int main(int argc, char *argv[]){
+    std::string wav;
+    double rate = 44100.0;
+    std::vector<std::string> paths;
+    for(int i = 1; i < argc; ++i){
+        if(std::strcmp(argv[i], "-o") == 0 && i + 1 < argc){
+            wav = argv[++i];
+        }else if(std::strcmp(argv[i], "-r") == 0 && i + 1 < argc){
+            rate = std::atof(argv[++i]);
+        }else{
+            paths.push_back(argv[i]);
+        }
+    }
+    if(paths.empty() || rate <= 0.0){
+        std::cerr << "usage: simulate [-o out.wav] [-r rate] <track>..." << std::endl;
+        return 1;
+    }
+
+    audio_output::null_sink *sink = wav.empty() ? new audio_output::null_sink(rate) : new audio_output::wav_sink(wav, rate);
+    if(!clover_system::audio.open(std::unique_ptr<audio_output::backend>(sink), audio_output::frames_unspecified)){
+        std::cerr << "cannot open output" << std::endl;
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    play_sound(paths);
+
+    // ŏ̋ȂȂ܂ł͑҂
+    long long start_frame = -1;
+    int blocks = 0;
+    bool failed = false;
+    for(;;){
+        sink->pump();
+        int n = sync_audible_spectrum();
+        if(take_playback_failure()){
+            failed = true;
+            break;
+        }
+        if(start_frame < 0){
+            if(n == 0){
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            start_frame = sink->frames();
+        }
+        blocks += n;
+        // ̓R[obNƓXbhȂ̂ finished Ăł悢
+        if(clover_system::music.finished()){
+            break;
+        }
+    }
+    long long frames = start_frame < 0 ? 0 : sink->frames() - start_frame;
+    const mixer::callback_stats stats = clover_system::audio.stats();
+
+    // pump ĂԂ̂͂̃XbhȂ̂, ɏo͂Ă
+    // (~LT[R[obN҂ɍւ悤ɂ) ZbV~߂
+    clover_system::audio.close();
+    shutdown_sound();
+    if(failed){
+        std::cerr << "no playable track" << std::endl;
+        return 2;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    double seconds = frames / rate;
+    std::cout << std::fixed << std::setprecision(2)
+        << paths.size() << " tracks, " << seconds << " s of audio in " << elapsed << " s ("
+        << (elapsed > 0.0 ? seconds / elapsed : 0.0) << "x realtime)\n"
+        << blocks << " analysis blocks\n"
+        << "callback: " << stats.callbacks << " calls, max " << stats.max_load * 100.0 << "% of deadline, "
+        << stats.histogram[mixer::callback_stats::load_bins - 1] << " over deadline" << std::endl;
+    return 0;
+}
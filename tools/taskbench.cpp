@@ -0,0 +1,231 @@
+//-------- ^XÑx`}[N
+// ĂIuWFNgʂ (100000)  tasklist  update/draw ,
+// z֐ŌĂłȑO̍ (legacy), task.hpp ̐ÓIȌĂяo (tasklist),
+// 擪ɋl߂Ď dense_tasklist,  jobs ŕɉ񂵂ׂ̂
+// ʂTEhfoCXgȂ
+//
+// g : taskbench [IuWFNg] [t[] [[J[]
+//
+// rh (Linux) :
+//   g++ -std=c++14 -O2 -I../clover taskbench.cpp ../clover/jobs.cpp ../clover/arena.cpp -lpthread -o taskbench
+// rh (Windows) :
+//   cl /O2 /EHsc /I..\clover taskbench.cpp ..\clover\jobs.cpp ..\clover\arena.cpp
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <cstdlib>
+#include "task.hpp"
+#include "jobs.hpp"
+
+namespace bench{
+    // őIuWFNg
+    const std::size_t capacity = 1 << 20;
+
+    // ɉ񂷂Ƃ1Ԃ̍ŏ̐
+    const std::size_t grain = 256;
+
+    const float field_width = 640.0f, field_height = 480.0f;
+
+    // draw ̌ʂ̂ĂȂ悤ɑ
+    volatile float sink;
+}
+
+//-------- ȑO̍ (IuWFNgƂɉz֐ŌĂ)
+namespace legacy{
+    template<class T>
+    struct task{
+        T obj;
+        task *next, *prev;
+        int thread;
+    };
+
+    template<class T>
+    struct object{
+        virtual void ctor(){}
+        virtual void dtor(){}
+        virtual void draw() const{}
+        virtual void update(task<T>*&) = 0;
+    };
+
+    template<class T, std::size_t N>
+    class tasklist{
+    private:
+        using task = ::legacy::task<T>;
+        std::size_t size_ = 0;
+        task active_, *free_;
+        std::array<task, N> arr;
+
+    public:
+        tasklist(){
+            for(std::size_t i = 0; i < N - 1; ++i){
+                arr[i].next = &arr[i + 1];
+            }
+            arr[N - 1].next = nullptr;
+            free_ = &arr[0];
+            active_.next = &active_;
+            active_.prev = &active_;
+        }
+
+        task *create_task(){
+            if(size_ == N){
+                return nullptr;
+            }
+            ++size_;
+            task *t = free_;
+            free_ = free_->next;
+            active_.next->prev = t;
+            t->next = active_.next;
+            active_.next = t;
+            t->prev = &active_;
+            t->obj.ctor();
+            return t;
+        }
+
+        void update(){
+            task *t = active_.next;
+            while(t != &active_){
+                static_cast<object<T>*>(&t->obj)->update(t);
+                if(t != &active_){
+                    t = t->next;
+                }
+            }
+        }
+
+        void draw() const{
+            const task *t = active_.next;
+            while(t != &active_){
+                static_cast<const object<T>*>(&t->obj)->draw();
+                t = t->next;
+            }
+        }
+    };
+
+    struct mover : public object<mover>{
+        float coord[2], speed[2];
+
+        void update(task<mover> *&) override{
+            coord[0] += speed[0];
+            coord[1] += speed[1];
+            if(coord[0] < 0.0f || coord[0] >= bench::field_width){
+                speed[0] = -speed[0];
+            }
+            if(coord[1] < 0.0f || coord[1] >= bench::field_height){
+                speed[1] = -speed[1];
+            }
+        }
+
+        void draw() const override{
+            bench::sink = bench::sink + coord[0] + coord[1];
+        }
+    };
+}
+
+//-------- task.hpp ̍
+namespace current{
+    struct mover : public object::object<mover>{
+        float coord[2], speed[2];
+
+        void update(::object::task<mover> *&){
+            coord[0] += speed[0];
+            coord[1] += speed[1];
+            if(coord[0] < 0.0f || coord[0] >= bench::field_width){
+                speed[0] = -speed[0];
+            }
+            if(coord[1] < 0.0f || coord[1] >= bench::field_height){
+                speed[1] = -speed[1];
+            }
+        }
+
+        void draw() const{
+            bench::sink = bench::sink + coord[0] + coord[1];
+        }
+    };
+}
+
+namespace dense{
+    struct mover : public ::object::object<mover>{
+        float coord[2], speed[2];
+
+        bool update(){
+            coord[0] += speed[0];
+            coord[1] += speed[1];
+            if(coord[0] < 0.0f || coord[0] >= bench::field_width){
+                speed[0] = -speed[0];
+            }
+            if(coord[1] < 0.0f || coord[1] >= bench::field_height){
+                speed[1] = -speed[1];
+            }
+            return true;
+        }
+
+        void draw() const{
+            bench::sink = bench::sink + coord[0] + coord[1];
+        }
+    };
+}
+
+template<class Task>
+auto &object_of(Task *t){
+    return t->obj;
+}
+
+inline dense::mover &object_of(dense::mover *m){
+    return *m;
+}
+
+// n  frames  update(list)/draw , 1IuWFNg1t[̎ (ns) Ԃ
+template<class List, class Update>
+double run(List &list, std::size_t n, int frames, Update update){
+    std::srand(1);
+    for(std::size_t i = 0; i < n; ++i){
+        auto &m = object_of(list.create_task());
+        m.coord[0] = static_cast<float>(std::rand() % 640);
+        m.coord[1] = static_cast<float>(std::rand() % 480);
+        m.speed[0] = static_cast<float>(std::rand() % 5 - 2);
+        m.speed[1] = static_cast<float>(std::rand() % 5 - 2);
+    }
+    auto begin = std::chrono::steady_clock::now();
+    for(int f = 0; f < frames; ++f){
+        update(list);
+        list.draw();
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    return elapsed / (static_cast<double>(n) * frames);
+}
+
+int main(int argc, char *argv[]){
+    std::size_t n = argc >= 2 ? static_cast<std::size_t>(std::atol(argv[1])) : 100000;
+    int frames = argc >= 3 ? std::atoi(argv[2]) : 200;
+    int threads = argc >= 4 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    if(n == 0 || n > bench::capacity || frames <= 0 || threads < 0){
+        std::cerr << "usage: taskbench [objects (1-" << bench::capacity << ")] [frames] [threads]" << std::endl;
+        return 1;
+    }
+
+    using legacy_list = legacy::tasklist<legacy::mover, bench::capacity>;
+    using current_list = ::object::tasklist<current::mover, bench::capacity>;
+    using dense_list = ::object::dense_tasklist<dense::mover, bench::capacity>;
+    std::unique_ptr<legacy_list> a(new legacy_list());
+    std::unique_ptr<current_list> b(new current_list());
+    std::unique_ptr<dense_list> c(new dense_list()), d(new dense_list());
+    jobs::scheduler s(threads);
+
+    auto serial = [](auto &list){ list.update(); };
+    double legacy_ns = run(*a, n, frames, serial);
+    double current_ns = run(*b, n, frames, serial);
+    double dense_ns = run(*c, n, frames, serial);
+    double jobs_ns = run(*d, n, frames, [&](dense_list &list){ list.update(s, bench::grain); });
+
+    std::cout << n << " objects, " << frames << " frames\n" << std::fixed << std::setprecision(2)
+        << "virtual : " << legacy_ns << " ns/object  (" << sizeof(legacy::task<legacy::mover>) << " bytes/task)\n"
+        << "static  : " << current_ns << " ns/object  (" << sizeof(object::task<current::mover>) << " bytes/task)  "
+        << legacy_ns / current_ns << "x\n"
+        << "dense   : " << dense_ns << " ns/object  (" << sizeof(dense::mover) << " bytes/object)  "
+        << legacy_ns / dense_ns << "x\n"
+        << "jobs    : " << jobs_ns << " ns/object  (" << threads << " workers)  "
+        << legacy_ns / jobs_ns << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,52 @@
+//-------- ȃCũXL
+// fBNgȉ̋Ȃ̃wb_ǂŃJ^Ot@C
+// ɃJ^OΕύX̖Ȃ͂̂܂܎g
+//
+// g : trackscan <fBNg> <J^O> [Xbh]
+//
+// rh (Linux) :
+//   g++ -std=c++14 -O2 -I../clover trackscan.cpp ../clover/track_catalog.cpp ../clover/audioprobe.cpp -lboost_filesystem -lboost_system -lpthread -o trackscan
+// rh (Windows) :
+//   cl /O2 /EHsc /I..\clover trackscan.cpp ..\clover\track_catalog.cpp ..\clover\audioprobe.cpp
+
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <cstdlib>
+#include "track_catalog.hpp"
+
+int main(int argc, char *argv[]){
+    if(argc < 3){
+        std::cerr << "usage: trackscan <directory> <catalog> [threads]" << std::endl;
+        return 1;
+    }
+    int threads = argc >= 4 ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+    if(threads <= 0){
+        threads = 1;
+    }
+
+    std::vector<track_catalog::entry> previous;
+    track_catalog::load(argv[2], previous);
+
+    track_catalog::scan_stats stats;
+    std::vector<track_catalog::entry> entries = track_catalog::scan(argv[1], previous, threads, &stats);
+    if(!track_catalog::save(argv[2], entries)){
+        std::cerr << "failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    double total_seconds = 0.0;
+    for(const auto &e : entries){
+        if(e.sample_rate > 0){
+            total_seconds += static_cast<double>(e.num_frames) / e.sample_rate;
+        }
+    }
+    std::cout << entries.size() << " tracks (" << std::fixed << std::setprecision(1) << total_seconds / 3600.0 << " h) in " << argv[2] << "\n"
+        << "  " << stats.files << " files, " << stats.probed << " probed, " << stats.reused << " unchanged, " << stats.failed << " unreadable\n"
+        << "  " << std::setprecision(3) << stats.seconds << " s with " << threads << " threads";
+    if(stats.probed > 0){
+        std::cout << ", " << std::setprecision(1) << stats.seconds * 1e6 / stats.probed << " us per probed file";
+    }
+    std::cout << std::endl;
+    return 0;
+}